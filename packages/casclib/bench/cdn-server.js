@@ -0,0 +1,258 @@
+#!/usr/bin/env node
+
+/**
+ * Local CDN stand-in for online storage benchmarks
+ * Serves recorded patch server and CDN content from a directory, with an
+ * injected per-request latency, HTTP keep-alive and byte range support.
+ * Point an online open at it with `cache*http://127.0.0.1:PORT*hero*us`.
+ *
+ * With --record, requests that are not in the directory are fetched from the
+ * upstream patch server (and from the CDN host it lists), saved, and served.
+ * The Hosts and Servers columns of recorded cdns files are rewritten to the
+ * stand-in, so that all CDN traffic comes back to it.
+ *
+ * The server counts requests and the largest number of requests in flight
+ * at once, which shows how much of an open is spent waiting on round trips.
+ *
+ * Usage:
+ *   node bench/cdn-server.js --dir DIR [--port N] [--latency MS] [--record http://us.patch.battle.net:1119]
+ */
+
+const fs = require('fs');
+const path = require('path');
+const http = require('http');
+const https = require('https');
+
+function parseArgs(argv) {
+  const args = { dir: null, port: 0, latency: 0, record: null };
+
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--dir': args.dir = argv[++i]; break;
+      case '--port': args.port = Number(argv[++i]); break;
+      case '--latency': args.latency = Number(argv[++i]); break;
+      case '--record': args.record = argv[++i]; break;
+      default:
+        console.error(`Unknown argument: ${argv[i]}`);
+        process.exit(1);
+    }
+  }
+
+  return args;
+}
+
+function download(url) {
+  return new Promise((resolve, reject) => {
+    const client = url.startsWith('https:') ? https : http;
+    client.get(url, (response) => {
+      if (response.statusCode !== 200) {
+        response.resume();
+        reject(new Error(`${url}: HTTP ${response.statusCode}`));
+        return;
+      }
+      const chunks = [];
+      response.on('data', (chunk) => chunks.push(chunk));
+      response.on('end', () => resolve(Buffer.concat(chunks)));
+      response.on('error', reject);
+    }).on('error', reject);
+  });
+}
+
+// Maps a request path into the content directory; null if it escapes it
+function getLocalPath(dir, urlPath) {
+  const relative = path.normalize(decodeURIComponent(urlPath)).replace(/^([/\\])+/, '');
+  if (!relative || relative.startsWith('..')) {
+    return null;
+  }
+  return path.join(dir, relative);
+}
+
+// The first host of the Hosts column of a cdns file (pipe-separated values)
+function getCdnHost(cdns) {
+  const lines = cdns.toString('utf8').split(/\r?\n/).filter((line) => line && !line.startsWith('#'));
+  const columns = lines[0].split('|').map((column) => column.split('!')[0]);
+  const hostsColumn = columns.indexOf('Hosts');
+  const row = lines.slice(1).find((line) => line.split('|').length === columns.length);
+  return hostsColumn >= 0 && row ? row.split('|')[hostsColumn].split(' ')[0] : null;
+}
+
+// Points the Hosts and Servers columns of a cdns file at the stand-in
+function rewriteCdns(cdns, host) {
+  const lines = cdns.toString('utf8').split(/\r?\n/);
+  const header = lines.findIndex((line) => line && !line.startsWith('#'));
+  if (header < 0) {
+    return cdns;
+  }
+
+  const columns = lines[header].split('|').map((column) => column.split('!')[0]);
+  const hostsColumn = columns.indexOf('Hosts');
+  const serversColumn = columns.indexOf('Servers');
+
+  for (let i = header + 1; i < lines.length; i++) {
+    const values = lines[i].split('|');
+    if (values.length !== columns.length) {
+      continue;
+    }
+    if (hostsColumn >= 0) {
+      values[hostsColumn] = host;
+    }
+    if (serversColumn >= 0) {
+      values[serversColumn] = `http://${host}/?maxhosts=4`;
+    }
+    lines[i] = values.join('|');
+  }
+
+  return Buffer.from(lines.join('\n'));
+}
+
+function parseRange(header, size) {
+  const match = /^bytes=(\d*)-(\d*)$/.exec(header || '');
+  if (!match || (!match[1] && !match[2])) {
+    return null;
+  }
+
+  let start = match[1] ? Number(match[1]) : size - Number(match[2]);
+  let end = match[1] && match[2] ? Number(match[2]) : size - 1;
+  start = Math.max(0, start);
+  end = Math.min(end, size - 1);
+  return start <= end ? { start, end } : null;
+}
+
+/**
+ * Start the stand-in
+ * @param {{ dir: string, port?: number, latency?: number, record?: string | null }} options
+ * @returns {Promise<{ port: number, url: string, stats: object, resetStats: () => void, close: () => Promise<void> }>}
+ */
+function startCdnServer(options) {
+  const dir = path.resolve(options.dir);
+  const latency = options.latency || 0;
+  const record = options.record ? options.record.replace(/\/+$/, '') : null;
+  const stats = { requests: 0, bytes: 0, notFound: 0, inFlight: 0, maxInFlight: 0, connections: 0 };
+  let cdnUpstream = null;
+  let host = null;
+
+  function findCdnUpstream() {
+    if (cdnUpstream || !fs.existsSync(dir)) {
+      return cdnUpstream;
+    }
+    for (const product of fs.readdirSync(dir)) {
+      const cdnsPath = path.join(dir, product, 'cdns');
+      if (fs.existsSync(cdnsPath)) {
+        cdnUpstream = getCdnHost(fs.readFileSync(cdnsPath));
+        if (cdnUpstream) {
+          break;
+        }
+      }
+    }
+    return cdnUpstream;
+  }
+
+  async function load(urlPath, localPath) {
+    if (fs.existsSync(localPath)) {
+      return fs.readFileSync(localPath);
+    }
+    if (!record) {
+      return null;
+    }
+
+    // CDN content lives under tpr/; everything else comes from the patch server
+    const upstream = urlPath.startsWith('/tpr/') ? findCdnUpstream() : record;
+    if (!upstream) {
+      return null;
+    }
+
+    const data = await download(`${upstream.includes('://') ? upstream : `http://${upstream}`}${urlPath}`);
+    fs.mkdirSync(path.dirname(localPath), { recursive: true });
+    fs.writeFileSync(`${localPath}.tmp`, data);
+    fs.renameSync(`${localPath}.tmp`, localPath);
+    return data;
+  }
+
+  async function handle(request, response) {
+    const urlPath = request.url.split('?')[0];
+    const localPath = getLocalPath(dir, urlPath);
+    let data = localPath ? await load(urlPath, localPath) : null;
+
+    if (latency > 0) {
+      await new Promise((resolve) => setTimeout(resolve, latency));
+    }
+
+    if (!data) {
+      stats.notFound++;
+      response.writeHead(404);
+      response.end();
+      return;
+    }
+
+    if (path.basename(urlPath) === 'cdns') {
+      data = rewriteCdns(data, host);
+    }
+
+    const size = data.length;
+    const range = parseRange(request.headers.range, size);
+    if (range) {
+      data = data.subarray(range.start, range.end + 1);
+      response.writeHead(206, {
+        'Content-Length': data.length,
+        'Content-Range': `bytes ${range.start}-${range.end}/${size}`
+      });
+    } else {
+      response.writeHead(200, { 'Content-Length': data.length });
+    }
+
+    stats.bytes += data.length;
+    response.end(data);
+  }
+
+  const server = http.createServer((request, response) => {
+    stats.requests++;
+    stats.inFlight++;
+    stats.maxInFlight = Math.max(stats.maxInFlight, stats.inFlight);
+
+    handle(request, response).catch((error) => {
+      response.writeHead(502);
+      response.end(String(error.message));
+    }).finally(() => {
+      stats.inFlight--;
+    });
+  });
+  server.keepAliveTimeout = 30000;
+  server.on('connection', () => stats.connections++);
+
+  return new Promise((resolve, reject) => {
+    server.once('error', reject);
+    server.listen(options.port || 0, '127.0.0.1', () => {
+      const port = server.address().port;
+      host = `127.0.0.1:${port}`;
+      resolve({
+        port,
+        url: `http://${host}`,
+        stats,
+        resetStats: () => Object.assign(stats, { requests: 0, bytes: 0, notFound: 0, maxInFlight: stats.inFlight, connections: 0 }),
+        close: () => new Promise((done) => {
+          server.closeAllConnections();
+          server.close(() => done());
+        })
+      });
+    });
+  });
+}
+
+module.exports = { startCdnServer };
+
+if (require.main === module) {
+  const args = parseArgs(process.argv.slice(2));
+
+  if (!args.dir) {
+    console.error('Usage: node bench/cdn-server.js --dir DIR [--port N] [--latency MS] [--record UPSTREAM]');
+    process.exit(1);
+  }
+
+  startCdnServer(args).then((cdn) => {
+    console.log(`Serving ${path.resolve(args.dir)} at ${cdn.url} (latency ${args.latency} ms${args.record ? `, recording from ${args.record}` : ''})`);
+    process.on('SIGINT', () => {
+      console.log(`\n${JSON.stringify(cdn.stats)}`);
+      cdn.close().then(() => process.exit(0));
+    });
+  });
+}
@@ -0,0 +1,500 @@
+#!/usr/bin/env node
+
+/**
+ * Synthetic local CASC storage generator
+ * Writes a small storage with everything CascOpenStorage needs: .build.info,
+ * build and CDN configs, 16 bucket .idx files, a data.000 archive, ENCODING
+ * and a TVFS root. File content is deterministic for a given seed, and files
+ * are encoded with a mix of zlib and uncompressed BLTE frames.
+ *
+ * Usage: node bench/fixture.js <outDir> [--files N] [--seed N]
+ */
+
+const fs = require('fs');
+const path = require('path');
+const crypto = require('crypto');
+const zlib = require('zlib');
+
+const FIXTURE_VERSION = 1;
+const FRAME_SIZE = 0x10000;
+const SEGMENT_SIZE = 0x40000000;
+const PAGE_SIZE_KB = 4;
+const LOCAL_HEADER_SIZE = 0x1E;
+
+// Bob Jenkins' lookup3 hashlittle2; returns [c, b] like the C version's *pc, *pb
+function hashlittle2(data, pc = 0, pb = 0) {
+  const rot = (x, k) => ((x << k) | (x >>> (32 - k))) >>> 0;
+  let length = data.length;
+  let a = (0xdeadbeef + length + pc) >>> 0;
+  let b = a;
+  let c = (a + pb) >>> 0;
+  let k = 0;
+
+  const mix = () => {
+    a = (a - c) >>> 0; a = (a ^ rot(c, 4)) >>> 0;  c = (c + b) >>> 0;
+    b = (b - a) >>> 0; b = (b ^ rot(a, 6)) >>> 0;  a = (a + c) >>> 0;
+    c = (c - b) >>> 0; c = (c ^ rot(b, 8)) >>> 0;  b = (b + a) >>> 0;
+    a = (a - c) >>> 0; a = (a ^ rot(c, 16)) >>> 0; c = (c + b) >>> 0;
+    b = (b - a) >>> 0; b = (b ^ rot(a, 19)) >>> 0; a = (a + c) >>> 0;
+    c = (c - b) >>> 0; c = (c ^ rot(b, 4)) >>> 0;  b = (b + a) >>> 0;
+  };
+
+  const final = () => {
+    c = (c ^ b) >>> 0; c = (c - rot(b, 14)) >>> 0;
+    a = (a ^ c) >>> 0; a = (a - rot(c, 11)) >>> 0;
+    b = (b ^ a) >>> 0; b = (b - rot(a, 25)) >>> 0;
+    c = (c ^ b) >>> 0; c = (c - rot(b, 16)) >>> 0;
+    a = (a ^ c) >>> 0; a = (a - rot(c, 4)) >>> 0;
+    b = (b ^ a) >>> 0; b = (b - rot(a, 14)) >>> 0;
+    c = (c ^ b) >>> 0; c = (c - rot(b, 24)) >>> 0;
+  };
+
+  while (length > 12) {
+    a = (a + data.readUInt32LE(k)) >>> 0;
+    b = (b + data.readUInt32LE(k + 4)) >>> 0;
+    c = (c + data.readUInt32LE(k + 8)) >>> 0;
+    mix();
+    length -= 12;
+    k += 12;
+  }
+
+  if (length === 0) {
+    return [c, b];
+  }
+
+  const tail = Buffer.alloc(12);
+  data.copy(tail, 0, k, k + length);
+  a = (a + tail.readUInt32LE(0)) >>> 0;
+  b = (b + tail.readUInt32LE(4)) >>> 0;
+  c = (c + tail.readUInt32LE(8)) >>> 0;
+  final();
+  return [c, b];
+}
+
+function md5(data) {
+  return crypto.createHash('md5').update(data).digest();
+}
+
+// Small deterministic PRNG (mulberry32), so a seed always gives the same storage
+function createRandom(seed) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6D2B79F5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function uint32BE(value) {
+  const buffer = Buffer.alloc(4);
+  buffer.writeUInt32BE(value >>> 0);
+  return buffer;
+}
+
+function uint40BE(value) {
+  const buffer = Buffer.alloc(5);
+  buffer.writeUInt8(Math.floor(value / 0x100000000) & 0xFF, 0);
+  buffer.writeUInt32BE(value >>> 0, 1);
+  return buffer;
+}
+
+/**
+ * Encode content as BLTE with a chunk table
+ * @param {Buffer} content - Decoded content
+ * @param {(index: number) => boolean} compress - Whether frame index uses zlib
+ * @returns {{ blte: Buffer, ekey: Buffer }}
+ */
+function encodeBlte(content, compress) {
+  const frames = [];
+  for (let offset = 0, index = 0; offset < content.length || index === 0; offset += FRAME_SIZE, index++) {
+    const chunk = content.subarray(offset, offset + FRAME_SIZE);
+    const encoded = compress(index)
+      ? Buffer.concat([Buffer.from('Z'), zlib.deflateSync(chunk)])
+      : Buffer.concat([Buffer.from('N'), chunk]);
+    frames.push({ encoded, size: chunk.length });
+  }
+
+  const headerSize = 12 + frames.length * 24;
+  const header = Buffer.alloc(headerSize);
+  header.write('BLTE', 0, 'latin1');
+  header.writeUInt32BE(headerSize, 4);
+  header.writeUInt32BE((0x0F << 24) | frames.length, 8);
+
+  frames.forEach((frame, i) => {
+    const entry = 12 + i * 24;
+    header.writeUInt32BE(frame.encoded.length, entry);
+    header.writeUInt32BE(frame.size, entry + 4);
+    md5(frame.encoded).copy(header, entry + 8);
+  });
+
+  return {
+    blte: Buffer.concat([header, ...frames.map((frame) => frame.encoded)]),
+    ekey: md5(header)
+  };
+}
+
+/**
+ * Build the ENCODING manifest
+ * @param {{ ckey: Buffer, ekey: Buffer, size: number, encodedSize: number, espec: number }[]} entries
+ * @param {string[]} especs - ESpec strings referenced by entry.espec
+ */
+function buildEncoding(entries, especs) {
+  const pageSize = PAGE_SIZE_KB * 1024;
+
+  function buildPages(sorted, entrySize, writeEntry, firstKey) {
+    const pages = [];
+    let page = null;
+    let used = 0;
+
+    for (const entry of sorted) {
+      if (page === null || used + entrySize > pageSize) {
+        page = { data: Buffer.alloc(pageSize), first: firstKey(entry) };
+        pages.push(page);
+        used = 0;
+      }
+      writeEntry(page.data, used, entry);
+      used += entrySize;
+    }
+
+    const index = Buffer.concat(pages.map((p) => Buffer.concat([p.first, md5(p.data)])));
+    return { index, data: Buffer.concat(pages.map((p) => p.data)), count: pages.length };
+  }
+
+  const byCKey = [...entries].sort((x, y) => Buffer.compare(x.ckey, y.ckey));
+  const ckeyPages = buildPages(byCKey, 1 + 5 + 16 + 16, (page, offset, entry) => {
+    page.writeUInt8(1, offset);
+    uint40BE(entry.size).copy(page, offset + 1);
+    entry.ckey.copy(page, offset + 6);
+    entry.ekey.copy(page, offset + 22);
+  }, (entry) => entry.ckey);
+
+  const byEKey = [...entries].sort((x, y) => Buffer.compare(x.ekey, y.ekey));
+  const ekeyPages = buildPages(byEKey, 16 + 4 + 5, (page, offset, entry) => {
+    entry.ekey.copy(page, offset);
+    page.writeUInt32BE(entry.espec, offset + 16);
+    uint40BE(entry.encodedSize).copy(page, offset + 20);
+  }, (entry) => entry.ekey);
+
+  const especBlock = Buffer.concat(especs.map((espec) => Buffer.from(espec + '\0', 'latin1')));
+
+  const header = Buffer.alloc(22);
+  header.write('EN', 0, 'latin1');
+  header.writeUInt8(1, 2);
+  header.writeUInt8(16, 3);
+  header.writeUInt8(16, 4);
+  header.writeUInt16BE(PAGE_SIZE_KB, 5);
+  header.writeUInt16BE(PAGE_SIZE_KB, 7);
+  header.writeUInt32BE(ckeyPages.count, 9);
+  header.writeUInt32BE(ekeyPages.count, 13);
+  header.writeUInt8(0, 17);
+  header.writeUInt32BE(especBlock.length, 18);
+
+  return Buffer.concat([
+    header, especBlock,
+    ckeyPages.index, ckeyPages.data,
+    ekeyPages.index, ekeyPages.data
+  ]);
+}
+
+/**
+ * Build a TVFS root listing every file as one path table entry
+ * @param {{ name: string, ekey: Buffer, size: number, encodedSize: number }[]} files
+ */
+function buildTvfsRoot(files) {
+  const cftEntrySize = 9 + 4 + 4;
+  const cftTable = Buffer.alloc(files.length * cftEntrySize);
+  const cftOffsetSize = cftTable.length > 0xFFFFFF ? 4 : cftTable.length > 0xFFFF ? 3 : cftTable.length > 0xFF ? 2 : 1;
+
+  const vfsEntrySize = 1 + 4 + 4 + cftOffsetSize;
+  const vfsTable = Buffer.alloc(files.length * vfsEntrySize);
+  const pathParts = [];
+
+  files.forEach((file, i) => {
+    const cftOffset = i * cftEntrySize;
+    file.ekey.copy(cftTable, cftOffset, 0, 9);
+    cftTable.writeUInt32BE(file.encodedSize, cftOffset + 9);
+    cftTable.writeUInt32BE(file.size, cftOffset + 13);
+
+    // One span covering the whole file
+    const vfsOffset = i * vfsEntrySize;
+    vfsTable.writeUInt8(1, vfsOffset);
+    vfsTable.writeUInt32BE(0, vfsOffset + 1);
+    vfsTable.writeUInt32BE(file.size, vfsOffset + 5);
+    vfsTable.writeUIntBE(cftOffset, vfsOffset + 9, cftOffsetSize);
+
+    const name = Buffer.from(file.name, 'utf8');
+    if (name.length > 0xFE) {
+      throw new Error(`File name too long for a path table fragment: ${file.name}`);
+    }
+    pathParts.push(Buffer.from([name.length]), name, Buffer.from([0xFF]), uint32BE(vfsOffset));
+  });
+
+  const pathTable = Buffer.concat(pathParts);
+  const headerSize = 0x26;
+  const header = Buffer.alloc(headerSize);
+  header.write('TVFS', 0, 'latin1');
+  header.writeUInt8(1, 4);
+  header.writeUInt8(headerSize, 5);
+  header.writeUInt8(9, 6);
+  header.writeUInt8(9, 7);
+  header.writeUInt32BE(0, 8);
+  header.writeUInt32BE(headerSize, 12);
+  header.writeUInt32BE(pathTable.length, 16);
+  header.writeUInt32BE(headerSize + pathTable.length, 20);
+  header.writeUInt32BE(vfsTable.length, 24);
+  header.writeUInt32BE(headerSize + pathTable.length + vfsTable.length, 28);
+  header.writeUInt32BE(cftTable.length, 32);
+  header.writeUInt16BE(1, 36);
+
+  return Buffer.concat([header, pathTable, vfsTable, cftTable]);
+}
+
+/**
+ * Build one bucket .idx file (version 7, 9-byte EKeys, 30-bit offsets)
+ * @param {number} bucket - Bucket index, 0 to 15
+ * @param {{ ekey: Buffer, offset: number, size: number }[]} entries
+ */
+function buildIndexFile(bucket, entries) {
+  const header = Buffer.alloc(16);
+  header.writeUInt16LE(7, 0);
+  header.writeUInt8(bucket, 2);
+  header.writeUInt8(0, 3);
+  header.writeUInt8(4, 4);
+  header.writeUInt8(5, 5);
+  header.writeUInt8(9, 6);
+  header.writeUInt8(30, 7);
+  header.writeBigUInt64LE(BigInt(SEGMENT_SIZE), 8);
+
+  const sorted = [...entries].sort((x, y) => Buffer.compare(x.ekey.subarray(0, 9), y.ekey.subarray(0, 9)));
+  const entryData = Buffer.alloc(sorted.length * 18);
+  let pc = 0;
+  let pb = 0;
+
+  sorted.forEach((entry, i) => {
+    const offset = i * 18;
+    entry.ekey.copy(entryData, offset, 0, 9);
+    // data.000, so the archive index bits above the 30-bit offset are zero
+    uint40BE(entry.offset).copy(entryData, offset + 9);
+    entryData.writeUInt32LE(entry.size, offset + 14);
+    [pc, pb] = hashlittle2(entryData.subarray(offset, offset + 18), pc, pb);
+  });
+
+  const headerBlock = Buffer.alloc(0x20);
+  headerBlock.writeUInt32LE(header.length, 0);
+  headerBlock.writeUInt32LE(hashlittle2(header)[0], 4);
+  header.copy(headerBlock, 8);
+
+  const entriesBlock = Buffer.alloc(8);
+  entriesBlock.writeUInt32LE(entryData.length, 0);
+  entriesBlock.writeUInt32LE(pc, 4);
+
+  return Buffer.concat([headerBlock, entriesBlock, entryData]);
+}
+
+function getBucketIndex(ekey) {
+  let value = 0;
+  for (let i = 0; i < 9; i++) {
+    value ^= ekey[i];
+  }
+  return (value & 0x0F) ^ (value >> 4);
+}
+
+// Compressible text-like content, so zlib frames behave like real game data
+function generateContent(random, size) {
+  const words = ['Unit', 'Hero', 'Ability', 'Effect', 'Behavior', 'Actor', 'Model', 'Button',
+    'Weapon', 'Validator', 'Requirement', 'Upgrade', 'Mover', 'Turret', 'Sound', 'Footprint'];
+  const buffer = Buffer.alloc(size);
+  let offset = 0;
+
+  while (offset < size) {
+    const line = `<C${words[Math.floor(random() * words.length)]} id="${Math.floor(random() * 1e6)}" ` +
+      `value="${random().toFixed(6)}"/>\n`;
+    offset += buffer.write(line, offset, 'latin1');
+  }
+
+  return buffer;
+}
+
+// Incompressible content for media-like assets
+function generateBytes(random, size) {
+  const buffer = Buffer.alloc(size);
+  for (let offset = 0; offset < size; offset += 4) {
+    const value = Math.floor(random() * 4294967296);
+    for (let i = 0; i < 4 && offset + i < size; i++) {
+      buffer[offset + i] = (value >>> (i * 8)) & 0xFF;
+    }
+  }
+  return buffer;
+}
+
+// Sizes from a rough log-uniform spread between 256 bytes and 512 KB
+function pickFileSize(random) {
+  return Math.floor(Math.exp(Math.log(256) + random() * (Math.log(512 * 1024) - Math.log(256))));
+}
+
+/**
+ * Generate a local CASC storage
+ * @param {string} outDir - Directory to create the storage in
+ * @param {{ files?: number, seed?: number }} options
+ * @returns The fixture manifest, also written to fixture.json
+ */
+function generateFixture(outDir, options = {}) {
+  const fileCount = options.files || 2000;
+  const seed = options.seed || 1;
+  const random = createRandom(seed);
+
+  const dataDir = path.join(outDir, 'Data', 'data');
+  const configDir = path.join(outDir, 'Data', 'config');
+  fs.mkdirSync(dataDir, { recursive: true });
+
+  const dataChunks = [];
+  let dataSize = 0;
+  const indexEntries = [];
+  const encodingEntries = [];
+
+  // Stores one BLTE blob in data.000 behind its 30-byte local header
+  function store(blte, ekey) {
+    const localHeader = Buffer.alloc(LOCAL_HEADER_SIZE);
+    Buffer.from(ekey).reverse().copy(localHeader, 0);
+    localHeader.writeUInt32LE(LOCAL_HEADER_SIZE + blte.length, 16);
+    localHeader.writeUInt32LE(hashlittle2(localHeader.subarray(0, 0x16))[0], 0x16);
+
+    indexEntries.push({ ekey, offset: dataSize, size: LOCAL_HEADER_SIZE + blte.length });
+    dataChunks.push(localHeader, blte);
+    dataSize += LOCAL_HEADER_SIZE + blte.length;
+  }
+
+  const dirs = ['mods/core.stormmod/base.stormdata', 'mods/heroes.stormmod/base.stormdata',
+    'mods/heromods/bench.stormmod/base.stormdata', 'mods/core.stormmod/enus.stormdata/localizeddata'];
+  const extensions = ['.xml', '.txt', '.dds', '.m3', '.ogg'];
+  const files = [];
+
+  for (let i = 0; i < fileCount; i++) {
+    const dir = dirs[i % dirs.length];
+    const ext = extensions[Math.floor(random() * extensions.length)];
+    const name = `${dir}/gamedata/file${String(i).padStart(6, '0')}${ext}`;
+    const size = pickFileSize(random);
+
+    // Text-like assets compress; media assets are stored, with a few mixed files
+    const textual = ext === '.xml' || ext === '.txt';
+    const content = textual ? generateContent(random, size) : generateBytes(random, size);
+    const mixed = !textual && random() < 0.1;
+    const { blte, ekey } = encodeBlte(content, (index) => textual || (mixed && index % 2 === 0));
+
+    const ckey = md5(content);
+    store(blte, ekey);
+    encodingEntries.push({ ckey, ekey, size, encodedSize: blte.length, espec: textual ? 0 : 1 });
+    files.push({ name, ekey, ckey, size, encodedSize: blte.length });
+  }
+
+  // The TVFS root is a regular file in ENCODING, like every other manifest
+  const root = buildTvfsRoot(files);
+  const rootCKey = md5(root);
+  const rootEncoded = encodeBlte(root, () => true);
+  store(rootEncoded.blte, rootEncoded.ekey);
+  encodingEntries.push({ ckey: rootCKey, ekey: rootEncoded.ekey, size: root.length,
+    encodedSize: rootEncoded.blte.length, espec: 0 });
+
+  const encoding = buildEncoding(encodingEntries, ['z', 'n']);
+  const encodingCKey = md5(encoding);
+  const encodingEncoded = encodeBlte(encoding, () => true);
+  store(encodingEncoded.blte, encodingEncoded.ekey);
+
+  fs.writeFileSync(path.join(dataDir, 'data.000'), Buffer.concat(dataChunks));
+
+  const buckets = Array.from({ length: 16 }, () => []);
+  for (const entry of indexEntries) {
+    buckets[getBucketIndex(entry.ekey)].push(entry);
+  }
+  buckets.forEach((entries, bucket) => {
+    const fileName = `${bucket.toString(16).padStart(2, '0')}${'1'.padStart(8, '0')}.idx`;
+    fs.writeFileSync(path.join(dataDir, fileName), buildIndexFile(bucket, entries));
+  });
+
+  const hex = (key) => key.toString('hex');
+  const buildConfig = [
+    '# Build Configuration',
+    '',
+    `root = ${hex(rootCKey)}`,
+    `encoding = ${hex(encodingCKey)} ${hex(encodingEncoded.ekey)}`,
+    `encoding-size = ${encoding.length} ${encodingEncoded.blte.length}`,
+    `vfs-root = ${hex(rootCKey)} ${hex(rootEncoded.ekey)}`,
+    `vfs-root-size = ${root.length} ${rootEncoded.blte.length}`,
+    'build-name = bench-fixture',
+    `build-uid = bench`,
+    `build-product = Bench`,
+    ''
+  ].join('\n');
+  const cdnConfig = ['# CDN Configuration', ''].join('\n');
+
+  function writeConfig(text) {
+    const key = hex(md5(Buffer.from(text)));
+    const dir = path.join(configDir, key.substring(0, 2), key.substring(2, 4));
+    fs.mkdirSync(dir, { recursive: true });
+    fs.writeFileSync(path.join(dir, key), text);
+    return key;
+  }
+
+  const buildKey = writeConfig(buildConfig);
+  const cdnKey = writeConfig(cdnConfig);
+
+  const buildInfo = [
+    'Branch!STRING:0|Active!DEC:1|Build Key!HEX:16|CDN Key!HEX:16|Install Key!HEX:16|IM Size!DEC:4|' +
+      'CDN Path!STRING:0|CDN Hosts!STRING:0|CDN Servers!STRING:0|Tags!STRING:0|Armadillo!STRING:0|' +
+      'Last Activated!STRING:0|Version!STRING:0|Product!STRING:0',
+    `us|1|${buildKey}|${cdnKey}|||tpr/bench|localhost|http://localhost/|Windows x86_64 US? enUS speech?:enUS text?|||1.0.0.${seed}|bench`,
+    ''
+  ].join('\n');
+  fs.writeFileSync(path.join(outDir, '.build.info'), buildInfo);
+
+  const manifest = {
+    fixtureVersion: FIXTURE_VERSION,
+    seed,
+    fileCount,
+    totalBytes: files.reduce((sum, file) => sum + file.size, 0),
+    encodedBytes: files.reduce((sum, file) => sum + file.encodedSize, 0),
+    files: files.map((file) => ({ name: file.name, size: file.size, ckey: hex(file.ckey) }))
+  };
+  fs.writeFileSync(path.join(outDir, 'fixture.json'), JSON.stringify(manifest, null, 2));
+  return manifest;
+}
+
+/**
+ * Return the manifest of an existing fixture with the same parameters, or
+ * generate a new one
+ */
+function ensureFixture(outDir, options = {}) {
+  const manifestPath = path.join(outDir, 'fixture.json');
+  if (fs.existsSync(manifestPath)) {
+    const manifest = JSON.parse(fs.readFileSync(manifestPath, 'utf8'));
+    if (manifest.fixtureVersion === FIXTURE_VERSION &&
+        manifest.fileCount === (options.files || 2000) &&
+        manifest.seed === (options.seed || 1)) {
+      return manifest;
+    }
+  }
+
+  fs.rmSync(outDir, { recursive: true, force: true });
+  return generateFixture(outDir, options);
+}
+
+module.exports = { generateFixture, ensureFixture, hashlittle2 };
+
+if (require.main === module) {
+  const args = process.argv.slice(2);
+  const outDir = args.find((arg, i) => !arg.startsWith('--') && (i === 0 || !args[i - 1].startsWith('--')));
+  const option = (name) => {
+    const index = args.indexOf(name);
+    return index >= 0 ? Number(args[index + 1]) : undefined;
+  };
+
+  if (!outDir) {
+    console.error('Usage: node bench/fixture.js <outDir> [--files N] [--seed N]');
+    process.exit(1);
+  }
+
+  const manifest = generateFixture(path.resolve(outDir), { files: option('--files'), seed: option('--seed') });
+  console.log(`Wrote ${manifest.fileCount} files (${(manifest.totalBytes / 1048576).toFixed(1)} MB) to ${outDir}`);
+}
@@ -0,0 +1,422 @@
+#!/usr/bin/env node
+
+/**
+ * Offline CascLib benchmark
+ * Runs against a synthetic local storage (see fixture.js), so it needs no
+ * network access. Measures storage open time, enumeration rate, open+readAll
+ * latency and throughput, parallel readFiles throughput and
+ * matchNameHashes rate, then writes the results as JSON.
+ *
+ * With --cdn, it also times cold online opens against the local CDN
+ * stand-in (see cdn-server.js) serving recorded content from DIR, with
+ * --latency milliseconds added to every request, and compares one-at-a-time
+ * CdnArchiveReader range reads with concurrent ones over keep-alive
+ * connections.
+ *
+ * Usage:
+ *   node bench/run.js [--files N] [--seed N] [--fixture DIR] [--iterations N] [--out FILE]
+ *                     [--cdn DIR [--product NAME] [--region NAME] [--latency MS] [--cdn-reads N]]
+ *   node bench/run.js --compare BASE.json HEAD.json
+ *
+ * Requires a built package (pnpm build).
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const crypto = require('crypto');
+const { ensureFixture } = require('./fixture');
+const { startCdnServer } = require('./cdn-server');
+
+const BENCH_VERSION = 1;
+
+function parseArgs(argv) {
+  const args = {
+    files: 2000, seed: 1, iterations: 5, fixture: null, out: null, compare: null, verify: false,
+    cdn: null, product: 'hero', region: 'us', latency: 20,
+    cdnReads: 200
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case '--files': args.files = Number(argv[++i]); break;
+      case '--seed': args.seed = Number(argv[++i]); break;
+      case '--iterations': args.iterations = Number(argv[++i]); break;
+      case '--fixture': args.fixture = argv[++i]; break;
+      case '--out': args.out = argv[++i]; break;
+      case '--verify': args.verify = true; break;
+      case '--compare': args.compare = [argv[++i], argv[++i]]; break;
+      case '--cdn': args.cdn = argv[++i]; break;
+      case '--product': args.product = argv[++i]; break;
+      case '--region': args.region = argv[++i]; break;
+      case '--latency': args.latency = Number(argv[++i]); break;
+      case '--cdn-reads': args.cdnReads = Number(argv[++i]); break;
+      default:
+        console.error(`Unknown argument: ${argv[i]}`);
+        process.exit(1);
+    }
+  }
+
+  return args;
+}
+
+function nowMs() {
+  return Number(process.hrtime.bigint()) / 1e6;
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  const index = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+  return sorted[Math.max(0, index)];
+}
+
+function round(value, digits = 3) {
+  const scale = Math.pow(10, digits);
+  return Math.round(value * scale) / scale;
+}
+
+function benchOpen(Storage, storagePath, iterations) {
+  const times = [];
+
+  for (let i = 0; i < iterations; i++) {
+    const storage = new Storage();
+    const start = nowMs();
+    storage.open(storagePath);
+    times.push(nowMs() - start);
+    storage.close();
+  }
+
+  times.sort((a, b) => a - b);
+  return { runs: iterations, minMs: round(times[0]), medianMs: round(percentile(times, 50)) };
+}
+
+// Every fixture name plus as many names that do not exist, as one listfile
+async function benchNameMatch(storage, files) {
+  const candidates = [];
+  for (const entry of files) {
+    candidates.push(entry.name, `${entry.name}.missing`);
+  }
+
+  const result = await storage.matchNameHashes(Buffer.from(candidates.join('\n')));
+  return {
+    candidates: result.candidates,
+    matched: result.names.length,
+    seconds: round(result.seconds),
+    namesPerSecond: Math.round(result.candidates / result.seconds)
+  };
+}
+
+function benchEnumerate(storage) {
+  const start = nowMs();
+  let entries = 0;
+
+  for (let batch = storage.findBatch('*', 4096); batch; batch = storage.findBatch(null, 4096)) {
+    entries += batch.count;
+  }
+
+  const seconds = (nowMs() - start) / 1000;
+  return { entries, seconds: round(seconds), entriesPerSecond: Math.round(entries / seconds) };
+}
+
+function benchReadAll(storage, files, verify) {
+  const times = [];
+  let bytes = 0;
+  let mismatches = 0;
+  const start = nowMs();
+
+  for (const entry of files) {
+    const fileStart = nowMs();
+    const file = storage.openFile(entry.name);
+    const data = file.readAll();
+    file.close();
+    times.push(nowMs() - fileStart);
+    bytes += data.length;
+
+    if (verify && crypto.createHash('md5').update(data).digest('hex') !== entry.ckey) {
+      mismatches++;
+    }
+  }
+
+  const seconds = (nowMs() - start) / 1000;
+  times.sort((a, b) => a - b);
+
+  const result = {
+    files: files.length,
+    bytes,
+    p50Ms: round(percentile(times, 50)),
+    p90Ms: round(percentile(times, 90)),
+    p99Ms: round(percentile(times, 99)),
+    maxMs: round(times[times.length - 1] || 0),
+    mbPerSecond: round(bytes / 1048576 / seconds, 1)
+  };
+
+  if (verify) {
+    result.mismatches = mismatches;
+  }
+  return result;
+}
+
+async function benchReadFiles(storage, files) {
+  const start = nowMs();
+  let bytes = 0;
+  let failed = 0;
+
+  for await (const result of storage.readFiles(files.map((entry) => entry.name))) {
+    if (result.data) {
+      bytes += result.data.length;
+    } else {
+      failed++;
+    }
+  }
+
+  const seconds = (nowMs() - start) / 1000;
+  return {
+    files: files.length,
+    failed,
+    threads: os.cpus().length,
+    seconds: round(seconds),
+    mbPerSecond: round(bytes / 1048576 / seconds, 1)
+  };
+}
+
+// Cold online opens, each with an empty cache folder, against the CDN stand-in
+async function benchOnlineOpen(Storage, args) {
+  const cdn = await startCdnServer({ dir: args.cdn, latency: args.latency });
+  const times = [];
+  let requests = 0;
+  let maxInFlight = 0;
+
+  try {
+    for (let i = 0; i < args.iterations; i++) {
+      const cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'casclib-bench-cache-'));
+      const storage = new Storage();
+      cdn.resetStats();
+
+      try {
+        const start = nowMs();
+        await storage.openAsync(`${cacheDir}*${cdn.url}*${args.product}*${args.region}`, { online: true });
+        times.push(nowMs() - start);
+        storage.close();
+      } finally {
+        fs.rmSync(cacheDir, { recursive: true, force: true });
+      }
+
+      requests = cdn.stats.requests;
+      maxInFlight = Math.max(maxInFlight, cdn.stats.maxInFlight);
+    }
+  } finally {
+    await cdn.close();
+  }
+
+  times.sort((a, b) => a - b);
+  return {
+    runs: args.iterations,
+    latencyMs: args.latency,
+    minMs: round(times[0]),
+    medianMs: round(percentile(times, 50)),
+    requests,
+    maxInFlight
+  };
+}
+
+// Row of a recorded versions or cdns file (pipe-separated values) for a region
+function readRegionRow(file, region) {
+  const lines = fs.readFileSync(file, 'utf8').split(/\r?\n/).filter((line) => line && !line.startsWith('#'));
+  const columns = lines[0].split('|').map((column) => column.split('!')[0]);
+  const row = lines.slice(1).map((line) => line.split('|')).find((values) => values[columns.indexOf('Region')] === region);
+  return row ? Object.fromEntries(columns.map((column, i) => [column, row[i]])) : null;
+}
+
+// The same archived EKeys read one at a time and with CdnArchiveReader.readMany,
+// each from an empty range cache. EKeys whose archives are not in the recording are skipped.
+async function benchCdnReads(Storage, CdnArchiveReader, args) {
+  const versions = readRegionRow(path.join(args.cdn, args.product, 'versions'), args.region);
+  const cdns = readRegionRow(path.join(args.cdn, args.product, 'cdns'), args.region);
+  if (!versions || !cdns) {
+    return null;
+  }
+
+  const cdn = await startCdnServer({ dir: args.cdn, latency: args.latency });
+  const cdnUrl = `${cdn.url}/${cdns.Path}`;
+  const dirs = [];
+  const newReader = async (concurrency) => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'casclib-bench-ranges-'));
+    dirs.push(dir);
+    return CdnArchiveReader.fromCdnConfig(cdnUrl, versions.CDNConfig, dir, { concurrency });
+  };
+
+  try {
+    // EKeys of the first files the storage lists that a reader can fetch
+    const cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'casclib-bench-cache-'));
+    dirs.push(cacheDir);
+    const storage = new Storage();
+    await storage.openAsync(`${cacheDir}*${cdn.url}*${args.product}*${args.region}`, { online: true });
+    const batch = storage.findBatch('*', args.cdnReads * 4);
+    storage.close();
+
+    const select = await newReader(16);
+    const candidates = [];
+    for (let i = 0; batch && i < batch.count; i++) {
+      const ekey = batch.ekeys.subarray(i * 16, i * 16 + 16);
+      if (select.has(ekey)) {
+        candidates.push(Buffer.from(ekey));
+      }
+    }
+    const settled = await Promise.allSettled(candidates.map((ekey) => select.readEncoded(ekey)));
+    select.close();
+    const ekeys = candidates.filter((_, i) => settled[i].status === 'fulfilled').slice(0, args.cdnReads);
+
+    const time = async (concurrency, readAll) => {
+      const reader = await newReader(concurrency);
+      cdn.resetStats();
+      const start = nowMs();
+      await readAll(reader);
+      const ms = nowMs() - start;
+      reader.close();
+      return { ms: round(ms), requests: cdn.stats.requests, maxInFlight: cdn.stats.maxInFlight, connections: cdn.stats.connections };
+    };
+
+    const serial = await time(1, async (reader) => {
+      for (const ekey of ekeys) {
+        await reader.read(ekey);
+      }
+    });
+    const concurrent = await time(8, (reader) => reader.readMany(ekeys));
+
+    return {
+      reads: ekeys.length,
+      latencyMs: args.latency,
+      serialMs: serial.ms,
+      serialConnections: serial.connections,
+      concurrentMs: concurrent.ms,
+      concurrentRequests: concurrent.requests,
+      concurrentMaxInFlight: concurrent.maxInFlight,
+      concurrentConnections: concurrent.connections
+    };
+  } finally {
+    await cdn.close();
+    for (const dir of dirs) {
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  }
+}
+
+// Flattens nested results into "group.metric" keys for comparison
+function flatten(object, prefix = '', out = {}) {
+  for (const [key, value] of Object.entries(object)) {
+    const name = prefix ? `${prefix}.${key}` : key;
+    if (value && typeof value === 'object') {
+      flatten(value, name, out);
+    } else if (typeof value === 'number') {
+      out[name] = value;
+    }
+  }
+  return out;
+}
+
+function compare(basePath, headPath) {
+  const base = flatten(JSON.parse(fs.readFileSync(basePath, 'utf8')).results);
+  const head = flatten(JSON.parse(fs.readFileSync(headPath, 'utf8')).results);
+  const rows = [];
+
+  for (const name of Object.keys(base)) {
+    if (!(name in head)) {
+      continue;
+    }
+    const change = base[name] ? ((head[name] - base[name]) / base[name]) * 100 : 0;
+    rows.push({ metric: name, base: base[name], head: head[name], change: `${change >= 0 ? '+' : ''}${change.toFixed(1)}%` });
+  }
+
+  console.table(rows);
+}
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+
+  if (args.compare) {
+    compare(args.compare[0], args.compare[1]);
+    return;
+  }
+
+  const { Storage, CdnArchiveReader, CASCLIB_VERSION_STRING } = require('../dist');
+  const packageJson = require('../package.json');
+
+  const fixtureDir = path.resolve(args.fixture || path.join(os.tmpdir(), `casclib-bench-${args.files}-${args.seed}`));
+  const fixtureStart = nowMs();
+  const manifest = ensureFixture(fixtureDir, { files: args.files, seed: args.seed });
+  console.log(`Fixture: ${fixtureDir} (${manifest.fileCount} files, ` +
+    `${(manifest.totalBytes / 1048576).toFixed(1)} MB, ${((nowMs() - fixtureStart) / 1000).toFixed(1)} s)`);
+
+  const results = {};
+  results.open = benchOpen(Storage, fixtureDir, args.iterations);
+  console.log(`open: median ${results.open.medianMs} ms`);
+
+  const storage = new Storage();
+  storage.open(fixtureDir);
+
+  results.enumerate = benchEnumerate(storage);
+  console.log(`enumerate: ${results.enumerate.entriesPerSecond} entries/s`);
+
+  storage.resetStats();
+  results.readAll = benchReadAll(storage, manifest.files, args.verify);
+  console.log(`open+readAll: p50 ${results.readAll.p50Ms} ms, p99 ${results.readAll.p99Ms} ms, ` +
+    `${results.readAll.mbPerSecond} MB/s`);
+  const stats = storage.getStats();
+
+  results.readFiles = await benchReadFiles(storage, manifest.files);
+  console.log(`readFiles: ${results.readFiles.mbPerSecond} MB/s on ${results.readFiles.threads} threads`);
+
+  results.nameMatch = await benchNameMatch(storage, manifest.files);
+  console.log(`matchNameHashes: ${results.nameMatch.namesPerSecond} names/s, ` +
+    `${results.nameMatch.matched} of ${results.nameMatch.candidates} matched`);
+
+  storage.close();
+
+  if (args.cdn) {
+    results.onlineOpen = await benchOnlineOpen(Storage, args);
+    console.log(`online open: median ${results.onlineOpen.medianMs} ms, ${results.onlineOpen.requests} requests, ` +
+      `at most ${results.onlineOpen.maxInFlight} in flight`);
+
+    results.cdnReads = await benchCdnReads(Storage, CdnArchiveReader, args);
+    if (results.cdnReads) {
+      console.log(`cdn reads (${results.cdnReads.reads}): ${results.cdnReads.serialMs} ms one at a time, ` +
+        `${results.cdnReads.concurrentMs} ms with readMany on ${results.cdnReads.concurrentConnections} connections`);
+    }
+  }
+
+  const report = {
+    benchVersion: BENCH_VERSION,
+    timestamp: new Date().toISOString(),
+    package: packageJson.version,
+    casclib: CASCLIB_VERSION_STRING,
+    node: process.version,
+    platform: `${process.platform}-${process.arch}`,
+    cpus: os.cpus().length,
+    cpuModel: os.cpus()[0] ? os.cpus()[0].model : 'unknown',
+    fixture: { files: manifest.fileCount, seed: manifest.seed, totalBytes: manifest.totalBytes, encodedBytes: manifest.encodedBytes },
+    results,
+    readAllStats: {
+      reads: stats.reads,
+      bytesRead: stats.bytesRead,
+      readMicros: stats.readTime.totalMicros,
+      openMicros: stats.openTime.totalMicros
+    }
+  };
+
+  const outPath = path.resolve(args.out || path.join(__dirname, 'results', `bench-${packageJson.version}-${Date.now()}.json`));
+  fs.mkdirSync(path.dirname(outPath), { recursive: true });
+  fs.writeFileSync(outPath, JSON.stringify(report, null, 2));
+  console.log(`Results written to ${outPath}`);
+
+  if (args.verify && results.readAll.mismatches > 0) {
+    console.error(`${results.readAll.mismatches} file(s) did not match their CKey`);
+    process.exitCode = 1;
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
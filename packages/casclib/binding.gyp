@@ -8,6 +8,13 @@
         "src/addon.cpp",
         "src/storage.cpp",
         "src/file.cpp",
+        "src/workers.cpp",
+        "src/find.cpp",
+        "src/lookup.cpp",
+        "src/cache.cpp",
+        "src/filepool.cpp",
+        "src/stats.cpp",
+        "src/nameindex.cpp",
         "../../thirdparty/CascLib/src/CascDecompress.cpp",
         "../../thirdparty/CascLib/src/CascDecrypt.cpp",
         "../../thirdparty/CascLib/src/CascDumpData.cpp",
@@ -62,7 +69,10 @@
             ],
             "msvs_settings": {
               "VCCLCompilerTool": {
-                "ExceptionHandling": 1
+                "ExceptionHandling": 1,
+                "AdditionalOptions": [
+                  "/std:c++17"
+                ]
               }
             }
           }
@@ -84,6 +94,7 @@
             "xcode_settings": {
               "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
               "CLANG_CXX_LIBRARY": "libc++",
+              "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
               "MACOSX_DEPLOYMENT_TARGET": "10.15"
             }
           }
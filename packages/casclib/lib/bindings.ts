@@ -45,6 +45,31 @@ export interface CascFindData {
   nameType: CascNameType;
 }
 
+// Columnar batch of find results
+// Entry i has its keys at ckeys/ekeys[i * MD5_HASH_SIZE] and its name at
+// names[nameOffsets[i]] .. names[nameOffsets[i + 1]] (UTF-8)
+export interface CascFindBatch {
+  count: number;
+  ckeys: Buffer;
+  ekeys: Buffer;
+  fileSizes: Float64Array;
+  tagBitMasks: Float64Array;
+  fileDataIds: Uint32Array;
+  localeFlags: Uint32Array;
+  contentFlags: Uint32Array;
+  spanCounts: Uint32Array;
+  available: Uint8Array;
+  nameTypes: Uint8Array;
+  names: Buffer;
+  nameOffsets: Uint32Array;
+}
+
+// Direct children of a directory, as returned by listDirectory
+export interface CascDirectoryListing {
+  directories: string[];
+  files: string[];
+}
+
 // Storage product info
 export interface CascStorageProduct {
   codeName: string;
@@ -105,6 +130,121 @@ export interface CascFileInfoResult {
   fileDataId?: number;
   localeFlags?: number;
   contentFlags?: number;
+  spans?: CascFileSpanInfo[];
+}
+
+// BLTE frames of a file, one entry per frame in each array
+export interface CascFileFrames {
+  count: number;
+  spanIndexes: Uint32Array;
+  contentOffsets: Float64Array;
+  contentSizes: Uint32Array;
+  encodedOffsets: Float64Array;
+  encodedSizes: Uint32Array;
+  modes: Uint8Array;
+}
+
+// Result delivered for each file by readFiles
+export interface CascReadFileResult {
+  index: number;
+  name: string;
+  data: Buffer | null;
+  error?: number;
+}
+
+// A file given by name, 16-byte CKey/EKey or FileDataId
+export type CascFileRef = string | Buffer | number;
+
+// Files given by names, packed 16-byte CKeys/EKeys or FileDataIds
+export type CascFileRefList = string[] | Uint8Array | Uint32Array;
+
+// Result of statMany; entry i of each column belongs to names[i]
+export interface CascStatManyResult {
+  found: Uint8Array;
+  sizes: Float64Array;
+  ckeys: Buffer;  // 16 bytes per entry, zeroed when not found
+  ekeys: Buffer;  // 16 bytes per entry, zeroed when not found
+}
+
+// Progress update delivered while verifyAll runs
+export interface CascVerifyProgress {
+  filesChecked: number;
+  filesTotal: number;
+  bytesChecked: number;
+}
+
+// Summary returned by verifyAll
+export interface CascVerifyResult {
+  filesTotal: number;  // Unique CKeys matched by the mask
+  filesChecked: number;
+  ok: number;
+  mismatched: string[];
+  missing: string[];
+  encrypted: string[];
+  failed: { name: string; error: number }[];
+  bytesChecked: number;
+  seconds: number;
+  filesPerSecond: number;
+  bytesPerSecond: number;
+  aborted: boolean;
+}
+
+// Call durations; buckets[i] counts calls under 2^(i+1) microseconds
+export interface CascTimeHistogram {
+  count: number;
+  totalMicros: number;
+  maxMicros: number;
+  buckets: number[];
+}
+
+// Counters returned by getStats
+export interface CascStorageStats {
+  storageOpens: number;
+  filesOpened: number;
+  filesClosed: number;
+  openFailures: number;
+  encodedBytesOpened: number;
+  contentBytesOpened: number;
+  lookups: number;
+  lookupFailures: number;
+  reads: number;
+  readFailures: number;
+  encryptedFailures: number;
+  bytesRead: number;
+  finds: number;
+  findEntries: number;
+  storageOpenTime: CascTimeHistogram;
+  openTime: CascTimeHistogram;
+  readTime: CascTimeHistogram;
+  findTime: CascTimeHistogram;
+}
+
+// Progress update delivered while extract runs
+export interface CascExtractProgress {
+  filesDone: number;
+  filesTotal: number;
+  bytesWritten: number;
+}
+
+// Summary returned by extract
+export interface CascExtractResult {
+  filesTotal: number;
+  filesWritten: number;
+  filesSkipped: number;  // Output already had the same size and MD5
+  failed: { name: string; error: number }[];
+  bytesWritten: number;
+  seconds: number;
+  filesPerSecond: number;
+  bytesPerSecond: number;
+  aborted: boolean;
+}
+
+// Result of matchNameHashes
+export interface CascNameMatchResult {
+  candidates: number;
+  found: Uint8Array;  // 1 for each candidate the root resolves, in candidate order
+  names: string[];    // The candidates that resolved
+  seconds: number;
 }
 
 export interface CascOpenStorageExOptions {
@@ -118,17 +258,58 @@ export interface CascOpenStorageExOptions {
   online?: boolean;
 }
 
+// Progress notification delivered while openAsync loads the storage
+export interface CascOpenProgress {
+  message: number;  // One of the CascProgress* constants
+  object: string | null;
+  current: number;
+  total: number;
+}
+
 export interface CascStorage {
   // Basic operations
   CascOpenStorage(path: string, flags: number): boolean;
   CascOpenOnlineStorage(path: string, flags: number): boolean;
   CascOpenStorageEx(params: string, options?: CascOpenStorageExOptions): boolean;
+  openAsync(  // Helper function, runs CascOpenStorageEx on a worker thread
+    params: string,
+    options?: CascOpenStorageExOptions,
+    onProgress?: (progress: CascOpenProgress) => boolean | void
+  ): Promise<boolean>;
   CascCloseStorage(): boolean;
   
   // File operations
-  CascOpenFile(filename: string, flags: number): CascFile;
+  CascOpenFile(filename: CascFileRef, flags: number): CascFile;
   CascGetFileInfo(filename: string): { name: string; size: number } | null;
-  fileExists(filename: string): boolean;  // Helper function, not in CascLib.h
+  fileExists(filename: CascFileRef, flags?: number): boolean;  // Helper function, not in CascLib.h
+  existsMany(filenames: CascFileRefList, flags?: number): Uint8Array;  // Helper function, not in CascLib.h
+  statMany(filenames: CascFileRefList, flags?: number): CascStatManyResult;  // Helper function, not in CascLib.h
+  readFiles(  // Helper function, reads files on a thread pool
+    names: CascFileRefList,
+    concurrency: number,
+    flags: number,
+    onFile: (result: CascReadFileResult, release: (count?: number) => void) => boolean | void,
+    window?: number  // Unreleased results before the workers pause; 0 is unbounded
+  ): Promise<number>;
+  
+  verifyAll(  // Helper function, checks decoded content against CKeys on a thread pool
+    mask: string,
+    threads: number,
+    listFile: string | undefined,
+    onProgress?: (progress: CascVerifyProgress) => boolean | void
+  ): Promise<CascVerifyResult>;
+  
+  extract(  // Helper function, writes matching files to a directory on a thread pool
+    mask: string,
+    outDir: string,
+    threads: number,
+    listFile: string | undefined,
+    onProgress?: (progress: CascExtractProgress) => boolean | void
+  ): Promise<CascExtractResult>;
+  matchNameHashes(candidates: string[] | Uint8Array, threads: number): Promise<CascNameMatchResult>;  // Helper function, resolves names through the root handler on a thread pool
+  
+  getStats(): CascStorageStats;  // Helper function, I/O and decode counters
+  resetStats(): void;  // Helper function, clears the counters
   
   // Storage info
   CascGetStorageInfo(infoClass: number): CascStorageInfo;
@@ -137,6 +318,11 @@ export interface CascStorage {
   CascFindFirstFile(mask?: string, listFile?: string): CascFindData | null;
   CascFindNextFile(): CascFindData | null;
   CascFindClose(): boolean;
+  findBatch(mask?: string | null, maxEntries?: number, listFile?: string): CascFindBatch | null;  // Helper function, not in CascLib.h
+  createFindIterator(mask?: string, batchSize?: number, listFile?: string): CascFindIterator;  // Helper function, not in CascLib.h
+  buildNameIndex(): Promise<number>;  // Helper function, not in CascLib.h
+  findPrefix(prefix: string): string[];  // Helper function, not in CascLib.h
+  listDirectory(path?: string): CascDirectoryListing;  // Helper function, not in CascLib.h
   
   // Encryption key operations
   CascAddEncryptionKey(keyName: number, key: Buffer): boolean;
@@ -151,6 +337,14 @@ export interface CascFile {
   // Basic read operations
   CascReadFile(bytesToRead: number): Buffer;
   readFileAll(): Buffer;  // Helper function, not in CascLib.h
+  readFileInto(target: Buffer | ArrayBufferView | ArrayBuffer, offset?: number, length?: number): number;  // Helper function, not in CascLib.h
+  readFileAsync(bytesToRead: number): Promise<Buffer>;  // Helper function, runs CascReadFile on a worker thread
+  readFileAllAsync(): Promise<Buffer>;  // Helper function, runs CascReadFile on a worker thread
+  readFileAt(offset: number, length: number): Buffer;  // Helper function, positional read
+  readFileAtAsync(offset: number, length: number): Promise<Buffer>;  // Helper function, positional read on a worker thread
+  getFileFrames(): CascFileFrames;  // Helper function, frame metadata
+  readFileFrames(first: number, count: number): Buffer;  // Helper function, decode a run of frames
+  readFileFramesAsync(first: number, count: number): Promise<Buffer>;  // Helper function, decode a run of frames on a worker thread
   
   // Size operations
   CascGetFileSize(): number;
@@ -170,8 +364,14 @@ export interface CascFile {
   CascCloseFile(): boolean;
 }
 
+export interface CascFindIterator {
+  nextBatch(): Promise<CascFindBatch | null>;  // Helper function, fetches on a worker thread
+  CascFindClose(): boolean;
+}
+
 export const CascStorageBinding: new () => CascStorage = bindings.Storage;
 export const CascFileBinding: new () => CascFile = bindings.File;
+export const CascFindIteratorBinding: new () => CascFindIterator = bindings.FindIterator;
 
 // Utility functions
 export const CascOpenLocalFile: (filename: string, flags?: number) => CascFile = bindings.CascOpenLocalFile;
@@ -182,6 +382,38 @@ export const SetCascError: (error: number) => void = bindings.SetCascError;
 export const CascCdnGetDefault: () => string | null = bindings.CascCdnGetDefault;
 export const CascCdnDownload: (cdnHostUrl: string, product: string, fileName: string) => Buffer | null = bindings.CascCdnDownload;
 
+// A file to download with cdnDownloadMany; the arguments of CascCdnDownload
+export interface CascCdnDownloadItem {
+  host: string;
+  product: string;
+  path: string;
+}
+
+// Options for cdnDownloadMany
+export interface CascCdnDownloadOptions {
+  concurrency?: number;  // Downloads in flight at once (default: 8)
+}
+
+// Helper function, downloads on a thread pool; one Promise per item, in order.
+// A failed download rejects its Promise with an Error naming the path and host.
+export const cdnDownloadMany: (items: CascCdnDownloadItem[], options?: CascCdnDownloadOptions) => Promise<Buffer>[] = bindings.cdnDownloadMany;
+
+// Content cache counters
+export interface ContentCacheStats {
+  hits: number;
+  misses: number;
+  evictions: number;
+  insertions: number;
+  entries: number;
+  bytes: number;
+  limit: number;
+}
+
+// Content cache functions (helpers, not in CascLib.h)
+export const setContentCacheLimit: (bytes: number) => void = bindings.setContentCacheLimit;
+export const getContentCacheStats: () => ContentCacheStats = bindings.getContentCacheStats;
+export const clearContentCache: () => void = bindings.clearContentCache;
+
 // Version constants
 export const CASCLIB_VERSION: number = bindings.CASCLIB_VERSION || 0x0300;
 export const CASCLIB_VERSION_STRING: string = "3.0";
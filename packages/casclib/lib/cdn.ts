@@ -0,0 +1,616 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import * as http from 'http';
+import * as https from 'https';
+import * as crypto from 'crypto';
+import * as zlib from 'zlib';
+import { promisify } from 'util';
+import type { OnlineCache } from './onlinecache';
+
+const inflate = promisify(zlib.inflate);
+
+/**
+ * Options for a CdnArchiveReader
+ */
+export interface CdnArchiveReaderOptions {
+  /** Product URL on a CDN host, e.g. "http://level3.blizzard.com/tpr/hero" */
+  cdnUrl: string;
+  /** Archive keys, as listed by the "archives" line of the CDN config */
+  archives: string[];
+  /** Local cache folder for archive indexes and fetched ranges */
+  cacheDir: string;
+  /** Requests in flight at once, and keep-alive connections kept open (default: 8) */
+  concurrency?: number;
+  /** Largest single range request; larger entries are split into ranges fetched in parallel (default: 1 MiB) */
+  rangeSize?: number;
+  /** Manager of cacheDir; every range read is also counted in its hits and misses */
+  onlineCache?: OnlineCache;
+}
+
+/**
+ * Counters returned by CdnArchiveReader.getStats()
+ */
+export interface CdnArchiveReaderStats {
+  rangeRequests: number;
+  bytesFetched: number;
+  cacheHits: number;     // Reads served from the sparse cache
+  cacheMisses: number;   // Reads fetched from the CDN
+  hitRate: number;       // cacheHits / (cacheHits + cacheMisses), 0 before the first read
+  bytesFromCache: number;
+}
+
+// Entries of one archive index, sorted by EKey
+interface ArchiveIndex {
+  archive: string;
+  count: number;
+  keys: Buffer;       // 16 bytes per entry
+  sizes: Float64Array;
+  offsets: Float64Array;
+}
+
+const KEY_SIZE = 16;
+const DEFAULT_CONCURRENCY = 8;
+const DEFAULT_RANGE_SIZE = 0x100000;
+
+// Runs task(0..count-1) with at most concurrency tasks pending at once
+async function runConcurrent(count: number, concurrency: number, task: (index: number) => Promise<void>): Promise<void> {
+  let next = 0;
+  const worker = async () => {
+    while (next < count) {
+      await task(next++);
+    }
+  };
+  await Promise.all(Array.from({ length: Math.min(Math.max(1, concurrency), count) }, worker));
+}
+
+/**
+ * Parse a CDN archive index (<archive>.index)
+ * The file is a run of fixed-size blocks of entries (EKey, BE size, BE offset),
+ * followed by a table of contents and a footer describing the field sizes.
+ * @param archive - Archive key the index belongs to
+ * @param data - Index file content
+ */
+function parseArchiveIndex(archive: string, data: Buffer): ArchiveIndex {
+  // The footer ends with the element count and a checksum of hashBytes bytes
+  const hashBytes = data[data.length - 13];
+  const footerSize = 12 + hashBytes * 2;
+  if (data.length < footerSize || hashBytes !== 8) {
+    throw new Error(`Unsupported archive index format: ${archive}`);
+  }
+
+  const footer = data.length - footerSize;
+  const blockSize = data[footer + hashBytes + 3] * 1024;
+  const offsetBytes = data[footer + hashBytes + 4];
+  const sizeBytes = data[footer + hashBytes + 5];
+  const keyBytes = data[footer + hashBytes + 6];
+  const entrySize = keyBytes + sizeBytes + offsetBytes;
+
+  if (data[footer + hashBytes] !== 1 || keyBytes !== KEY_SIZE || blockSize === 0 ||
+      sizeBytes > 6 || offsetBytes > 6) {
+    throw new Error(`Unsupported archive index format: ${archive}`);
+  }
+
+  const blockCount = Math.floor(footer / (blockSize + keyBytes + hashBytes));
+  const entriesPerBlock = Math.floor(blockSize / entrySize);
+  const maxCount = blockCount * entriesPerBlock;
+  const keys = Buffer.alloc(maxCount * KEY_SIZE);
+  const sizes = new Float64Array(maxCount);
+  const offsets = new Float64Array(maxCount);
+  let count = 0;
+
+  for (let block = 0; block < blockCount; block++) {
+    for (let i = 0; i < entriesPerBlock; i++) {
+      const pos = block * blockSize + i * entrySize;
+
+      // Blocks are zero-padded after their last entry
+      if (data.subarray(pos, pos + keyBytes).every((byte) => byte === 0)) {
+        break;
+      }
+
+      data.copy(keys, count * KEY_SIZE, pos, pos + KEY_SIZE);
+      sizes[count] = data.readUIntBE(pos + keyBytes, sizeBytes);
+      offsets[count] = data.readUIntBE(pos + keyBytes + sizeBytes, offsetBytes);
+      count++;
+    }
+  }
+
+  return {
+    archive,
+    count,
+    keys: keys.subarray(0, count * KEY_SIZE),
+    sizes: sizes.subarray(0, count),
+    offsets: offsets.subarray(0, count)
+  };
+}
+
+// Index of an EKey in an archive index, or -1
+function findArchiveEntry(index: ArchiveIndex, ekey: Buffer): number {
+  let low = 0;
+  let high = index.count - 1;
+
+  while (low <= high) {
+    const middle = (low + high) >>> 1;
+    const order = index.keys.compare(ekey, 0, KEY_SIZE, middle * KEY_SIZE, middle * KEY_SIZE + KEY_SIZE);
+
+    if (order < 0) {
+      low = middle + 1;
+    } else if (order > 0) {
+      high = middle - 1;
+    } else {
+      return middle;
+    }
+  }
+
+  return -1;
+}
+
+function md5(data: Buffer): Buffer {
+  return crypto.createHash('md5').update(data).digest();
+}
+
+// Encoded frames of a BLTE stream, with the MD5 the header records for each (if any)
+function getBlteFrames(data: Buffer): { frame: Buffer; hash: Buffer | null }[] {
+  if (data.length < 8 || data.toString('latin1', 0, 4) !== 'BLTE') {
+    throw new Error('Not a BLTE stream');
+  }
+
+  const headerSize = data.readUInt32BE(4);
+  if (headerSize === 0) {
+    return [{ frame: data.subarray(8), hash: null }];
+  }
+
+  const frameCount = data.readUIntBE(9, 3);
+  if (headerSize < 12 + frameCount * 24 || headerSize > data.length) {
+    throw new Error('Corrupt BLTE header');
+  }
+
+  const frames: { frame: Buffer; hash: Buffer | null }[] = [];
+  let position = headerSize;
+
+  for (let i = 0; i < frameCount; i++) {
+    const entry = 12 + i * 24;
+    const encodedSize = data.readUInt32BE(entry);
+    if (position + encodedSize > data.length) {
+      throw new Error('Truncated BLTE stream');
+    }
+    frames.push({ frame: data.subarray(position, position + encodedSize), hash: data.subarray(entry + 8, entry + 24) });
+    position += encodedSize;
+  }
+
+  return frames;
+}
+
+/**
+ * Check a BLTE stream against its EKey and the frame hashes in its header
+ * The EKey is the MD5 of the header, or of the whole stream when it has no
+ * header; each frame listed in the header carries the MD5 of its bytes.
+ * @param data - BLTE stream, starting with the "BLTE" signature
+ * @param ekey - 16-byte EKey the stream was fetched for
+ * @returns true if every hash matches
+ */
+export function verifyBlte(data: Buffer, ekey: Buffer): boolean {
+  if (data.length < 8 || data.toString('latin1', 0, 4) !== 'BLTE') {
+    return false;
+  }
+
+  const headerSize = data.readUInt32BE(4);
+  if (!md5(headerSize === 0 ? data : data.subarray(0, headerSize)).equals(ekey)) {
+    return false;
+  }
+
+  try {
+    return getBlteFrames(data).every(({ frame, hash }) => !hash || md5(frame).equals(hash));
+  } catch {
+    return false;
+  }
+}
+
+async function decodeBlteFrame(frame: Buffer): Promise<Buffer> {
+  switch (String.fromCharCode(frame[0])) {
+    case 'N':
+      return frame.subarray(1);
+    case 'Z':
+      return inflate(frame.subarray(1));
+    case 'F':
+      return decodeBlte(frame.subarray(1));
+    case 'E':
+      throw new Error('Encrypted BLTE frames are not supported');
+    default:
+      throw new Error(`Unknown BLTE frame mode: 0x${frame[0].toString(16)}`);
+  }
+}
+
+function decodeBlteFrameSync(frame: Buffer): Buffer {
+  switch (String.fromCharCode(frame[0])) {
+    case 'N':
+      return frame.subarray(1);
+    case 'Z':
+      return zlib.inflateSync(frame.subarray(1));
+    case 'F':
+      return decodeBlteSync(frame.subarray(1));
+    case 'E':
+      throw new Error('Encrypted BLTE frames are not supported');
+    default:
+      throw new Error(`Unknown BLTE frame mode: 0x${frame[0].toString(16)}`);
+  }
+}
+
+/**
+ * Decode a BLTE-encoded buffer on the calling thread
+ * Same as decodeBlte(), for callers that cannot wait; zlib frames block
+ * the event loop while they are inflated.
+ * @param data - BLTE stream, starting with the "BLTE" signature
+ * @returns Decoded content
+ */
+export function decodeBlteSync(data: Buffer): Buffer {
+  const decoded = getBlteFrames(data).map(({ frame, hash }) => {
+    if (hash && !md5(frame).equals(hash)) {
+      throw new Error('BLTE frame does not match its hash');
+    }
+    return decodeBlteFrameSync(frame);
+  });
+  return decoded.length === 1 ? decoded[0] : Buffer.concat(decoded);
+}
+
+/**
+ * Decode a BLTE-encoded buffer
+ * Supports uncompressed (N), zlib (Z) and nested (F) frames. Frames are
+ * checked against the hashes in the header, and zlib frames are inflated
+ * on the libuv thread pool.
+ * @param data - BLTE stream, starting with the "BLTE" signature
+ * @returns Decoded content
+ */
+export async function decodeBlte(data: Buffer): Promise<Buffer> {
+  const frames = getBlteFrames(data);
+
+  for (const { frame, hash } of frames) {
+    if (hash && !md5(frame).equals(hash)) {
+      throw new Error('BLTE frame does not match its hash');
+    }
+  }
+
+  const decoded = await Promise.all(frames.map(({ frame }) => decodeBlteFrame(frame)));
+  return decoded.length === 1 ? decoded[0] : Buffer.concat(decoded);
+}
+
+// Adds [start, end) to a sorted list of disjoint ranges, merging neighbours
+function addRange(ranges: [number, number][], start: number, end: number): [number, number][] {
+  const merged: [number, number][] = [];
+
+  for (const range of ranges) {
+    if (range[1] < start || range[0] > end) {
+      merged.push(range);
+    } else {
+      start = Math.min(start, range[0]);
+      end = Math.max(end, range[1]);
+    }
+  }
+
+  merged.push([start, end]);
+  return merged.sort((a, b) => a[0] - b[0]);
+}
+
+function hasRange(ranges: [number, number][], start: number, end: number): boolean {
+  return ranges.some((range) => range[0] <= start && range[1] >= end);
+}
+
+/**
+ * Reads files from CDN data archives with HTTP range requests
+ *
+ * Only the bytes an EKey occupies inside its archive are downloaded. Fetched
+ * ranges are written at their archive offsets into sparse files in the cache
+ * folder, next to a list of the ranges each file holds, so later reads and
+ * later processes reuse them. Archive indexes are downloaded once and kept
+ * in the cache folder.
+ *
+ * EKeys come from an open online storage, e.g. from statMany() or getFileInfo().
+ */
+export class CdnArchiveReader {
+  private options: CdnArchiveReaderOptions;
+  private agent: http.Agent;
+  private indexes: ArchiveIndex[] = [];
+  private ranges = new Map<string, [number, number][]>();
+  private stats: CdnArchiveReaderStats = { rangeRequests: 0, bytesFetched: 0, cacheHits: 0, cacheMisses: 0, hitRate: 0, bytesFromCache: 0 };
+
+  constructor(options: CdnArchiveReaderOptions) {
+    this.options = { ...options, cdnUrl: options.cdnUrl.replace(/\/+$/, '') };
+    const client = this.options.cdnUrl.startsWith('https:') ? https : http;
+    this.agent = new client.Agent({ keepAlive: true, maxSockets: options.concurrency || DEFAULT_CONCURRENCY });
+  }
+
+  /**
+   * Create a reader for the archives listed in a CDN config
+   * @param cdnUrl - Product URL on a CDN host
+   * @param cdnConfig - CDN config key (the "CDN Key" of .build.info or the versions file)
+   * @param cacheDir - Local cache folder
+   * @param options - Optional concurrency, range size and cache manager
+   * @returns A reader with its archive indexes loaded
+   */
+  static async fromCdnConfig(cdnUrl: string, cdnConfig: string, cacheDir: string,
+                             options?: Pick<CdnArchiveReaderOptions, 'concurrency' | 'rangeSize' | 'onlineCache'>): Promise<CdnArchiveReader> {
+    const bootstrap = new CdnArchiveReader({ cdnUrl, archives: [], cacheDir });
+    let config: string;
+    try {
+      config = (await bootstrap.fetchCached('config', cdnConfig, '')).toString('utf8');
+    } finally {
+      bootstrap.close();
+    }
+
+    const line = config.split(/\r?\n/).find((text) => /^archives\s*=/.test(text));
+    const archives = line ? line.split('=')[1].trim().split(/\s+/).filter(Boolean) : [];
+
+    const reader = new CdnArchiveReader({ ...options, cdnUrl, archives, cacheDir });
+    await reader.loadIndexes();
+    return reader;
+  }
+
+  /**
+   * Download (or load from the cache folder) and parse every archive index
+   */
+  async loadIndexes(): Promise<void> {
+    const archives = this.options.archives;
+    const indexes: ArchiveIndex[] = new Array(archives.length);
+
+    await runConcurrent(archives.length, this.options.concurrency || DEFAULT_CONCURRENCY, async (i) => {
+      indexes[i] = parseArchiveIndex(archives[i], await this.fetchCached('data', archives[i], '.index'));
+    });
+    this.indexes = indexes;
+  }
+
+  /**
+   * Check if an EKey is stored in one of the archives
+   * @param ekey - 16-byte EKey as a Buffer or hex string
+   */
+  has(ekey: Buffer | string): boolean {
+    return this.locate(ekey) !== null;
+  }
+
+  /**
+   * Get the BLTE-encoded bytes of an EKey
+   * @param ekey - 16-byte EKey as a Buffer or hex string
+   * @returns The encoded data
+   */
+  async readEncoded(ekey: Buffer | string): Promise<Buffer> {
+    const location = this.locate(ekey);
+    if (!location) {
+      throw new Error(`EKey not found in any archive: ${toHex(ekey)}`);
+    }
+
+    const key = toKey(ekey);
+    const { archive, offset, size } = location;
+    const dataPath = this.getCachePath('data', archive, '');
+    const ranges = this.getRanges(archive);
+
+    // A range written by a process that died mid-write fails the check and is fetched again
+    if (hasRange(ranges, offset, offset + size)) {
+      const data = await this.readCachedRange(dataPath, offset, size);
+      if (data && verifyBlte(data, key)) {
+        this.countRead(true);
+        this.stats.bytesFromCache += size;
+        return data;
+      }
+    }
+
+    const data = await this.fetchRange(archive, offset, size);
+    this.countRead(false);
+
+    // Only data that matches its EKey and frame hashes is kept
+    if (!verifyBlte(data, key)) {
+      throw new Error(`Data fetched for EKey ${toHex(ekey)} does not match its hashes`);
+    }
+
+    // Create without truncating, so concurrent first writes to an archive keep each other's ranges
+    fs.mkdirSync(path.dirname(dataPath), { recursive: true });
+    fs.closeSync(fs.openSync(dataPath, 'a'));
+    const handle = await fs.promises.open(dataPath, 'r+');
+    try {
+      await handle.write(data, 0, data.length, offset);
+    } finally {
+      await handle.close();
+    }
+    this.saveRange(archive, offset, offset + size);
+
+    return data;
+  }
+
+  /**
+   * Get the decoded content of an EKey
+   * @param ekey - 16-byte EKey as a Buffer or hex string
+   * @param ckey - Optional 16-byte CKey the decoded content must hash to
+   * @returns The decoded content
+   */
+  async read(ekey: Buffer | string, ckey?: Buffer | string): Promise<Buffer> {
+    const content = await decodeBlte(await this.readEncoded(ekey));
+    if (ckey && !md5(content).equals(toKey(ckey))) {
+      throw new Error(`Content of EKey ${toHex(ekey)} does not match CKey ${toHex(ckey)}`);
+    }
+    return content;
+  }
+
+  /**
+   * Get the decoded content of many EKeys
+   * Up to `concurrency` reads are in flight at once, sharing the reader's
+   * keep-alive connections.
+   * @param ekeys - 16-byte EKeys as Buffers or hex strings
+   * @returns Decoded content, in the order of ekeys
+   */
+  async readMany(ekeys: (Buffer | string)[]): Promise<Buffer[]> {
+    const results: Buffer[] = new Array(ekeys.length);
+    await runConcurrent(ekeys.length, this.options.concurrency || DEFAULT_CONCURRENCY, async (i) => {
+      results[i] = await this.read(ekeys[i]);
+    });
+    return results;
+  }
+
+  /**
+   * Get range request and cache counters
+   */
+  getStats(): CdnArchiveReaderStats {
+    const reads = this.stats.cacheHits + this.stats.cacheMisses;
+    return { ...this.stats, hitRate: reads ? this.stats.cacheHits / reads : 0 };
+  }
+
+  /**
+   * Close the reader's keep-alive connections
+   */
+  close(): void {
+    this.agent.destroy();
+  }
+
+  private locate(ekey: Buffer | string): { archive: string; offset: number; size: number } | null {
+    const key = toKey(ekey);
+
+    for (const index of this.indexes) {
+      const entry = findArchiveEntry(index, key);
+      if (entry >= 0) {
+        return { archive: index.archive, offset: index.offsets[entry], size: index.sizes[entry] };
+      }
+    }
+    return null;
+  }
+
+  // CDN layout: <type>/<key[0:2]>/<key[2:4]>/<key><suffix>
+  private getUrl(type: string, key: string, suffix: string): string {
+    return `${this.options.cdnUrl}/${type}/${key.substring(0, 2)}/${key.substring(2, 4)}/${key}${suffix}`;
+  }
+
+  private getCachePath(type: string, key: string, suffix: string): string {
+    return path.join(this.options.cacheDir, type, key.substring(0, 2), key.substring(2, 4), `${key}${suffix}`);
+  }
+
+  // Whole small files (configs and archive indexes), downloaded once
+  private async fetchCached(type: string, key: string, suffix: string): Promise<Buffer> {
+    const cachePath = this.getCachePath(type, key, suffix);
+    if (fs.existsSync(cachePath)) {
+      return fs.readFileSync(cachePath);
+    }
+
+    const data = await this.download(this.getUrl(type, key, suffix));
+    fs.mkdirSync(path.dirname(cachePath), { recursive: true });
+    fs.writeFileSync(`${cachePath}.${process.pid}.tmp`, data);
+    fs.renameSync(`${cachePath}.${process.pid}.tmp`, cachePath);
+    return data;
+  }
+
+  // Bytes of a cached range; null when the sparse file is missing or short,
+  // e.g. after an OnlineCache evicted it
+  private async readCachedRange(dataPath: string, offset: number, size: number): Promise<Buffer | null> {
+    let handle: fs.promises.FileHandle;
+    try {
+      handle = await fs.promises.open(dataPath, 'r');
+    } catch {
+      return null;
+    }
+
+    try {
+      const data = Buffer.alloc(size);
+      const { bytesRead } = await handle.read(data, 0, size, offset);
+      return bytesRead === size ? data : null;
+    } finally {
+      await handle.close();
+    }
+  }
+
+  private countRead(hit: boolean): void {
+    if (hit) {
+      this.stats.cacheHits++;
+    } else {
+      this.stats.cacheMisses++;
+    }
+    this.options.onlineCache?.recordRead(hit);
+  }
+
+  // One range of an archive; large ranges are split and fetched in parallel
+  private async fetchRange(archive: string, offset: number, size: number): Promise<Buffer> {
+    const url = this.getUrl('data', archive, '');
+    const rangeSize = this.options.rangeSize || DEFAULT_RANGE_SIZE;
+    const parts: Buffer[] = new Array(Math.max(1, Math.ceil(size / rangeSize)));
+
+    await runConcurrent(parts.length, this.options.concurrency || DEFAULT_CONCURRENCY, async (i) => {
+      const start = offset + i * rangeSize;
+      parts[i] = await this.download(url, start, Math.min(rangeSize, offset + size - start));
+      this.stats.rangeRequests++;
+      this.stats.bytesFetched += parts[i].length;
+    });
+
+    return parts.length === 1 ? parts[0] : Buffer.concat(parts);
+  }
+
+  private getRanges(archive: string): [number, number][] {
+    let ranges = this.ranges.get(archive);
+    if (!ranges) {
+      const rangesPath = this.getCachePath('data', archive, '.ranges');
+      ranges = fs.existsSync(rangesPath) ? JSON.parse(fs.readFileSync(rangesPath, 'utf8')) as [number, number][] : [];
+      this.ranges.set(archive, ranges);
+    }
+    return ranges;
+  }
+
+  // Records a fetched range. The list on disk is read again and merged, so
+  // ranges saved by other processes since this one loaded it are kept, and
+  // each process writes through its own temporary file.
+  private saveRange(archive: string, start: number, end: number): void {
+    const rangesPath = this.getCachePath('data', archive, '.ranges');
+    const tempPath = `${rangesPath}.${process.pid}.tmp`;
+    let ranges = addRange(this.getRanges(archive), start, end);
+
+    try {
+      for (const range of JSON.parse(fs.readFileSync(rangesPath, 'utf8')) as [number, number][]) {
+        ranges = addRange(ranges, range[0], range[1]);
+      }
+    } catch {
+      // Missing or unreadable; this process's ranges replace it
+    }
+
+    this.ranges.set(archive, ranges);
+    fs.writeFileSync(tempPath, JSON.stringify(ranges));
+    fs.renameSync(tempPath, rangesPath);
+  }
+
+  private download(url: string, offset?: number, size?: number): Promise<Buffer> {
+    const client = url.startsWith('https:') ? https : http;
+    const headers: http.OutgoingHttpHeaders = {};
+    if (offset !== undefined && size !== undefined) {
+      headers.Range = `bytes=${offset}-${offset + size - 1}`;
+    }
+
+    return new Promise((resolve, reject) => {
+      client.get(url, { agent: this.agent, headers }, (response) => {
+        const status = response.statusCode || 0;
+        if (status !== 200 && status !== 206) {
+          response.resume();
+          reject(new Error(`${url}: HTTP ${status}`));
+          return;
+        }
+
+        const chunks: Buffer[] = [];
+        response.on('data', (chunk: Buffer) => chunks.push(chunk));
+        response.on('error', reject);
+        response.on('end', () => {
+          let data = Buffer.concat(chunks);
+          // A server that ignores Range sends the whole archive
+          if (status === 200 && offset !== undefined && size !== undefined) {
+            data = data.subarray(offset, offset + size);
+          }
+          if (size !== undefined && data.length !== size) {
+            reject(new Error(`${url}: expected ${size} bytes, got ${data.length}`));
+            return;
+          }
+          resolve(data);
+        });
+      }).on('error', reject);
+    });
+  }
+}
+
+function toHex(ekey: Buffer | string): string {
+  return typeof ekey === 'string' ? ekey : ekey.toString('hex');
+}
+
+function toKey(key: Buffer | string): Buffer {
+  const buffer = typeof key === 'string' ? Buffer.from(key, 'hex') : key;
+  if (buffer.length !== KEY_SIZE) {
+    throw new TypeError('Keys must be 16 bytes');
+  }
+  return buffer;
+}
@@ -1,11 +1,28 @@
+import * as os from 'os';
+import { Readable } from 'stream';
 import { 
   CascStorageBinding, 
   CascFileBinding, 
   CascFindData, 
+  CascFindBatch,
+  CascFindIterator,
+  CascDirectoryListing,
   CascStorageInfo, 
   CascFileInfoResult, 
+  CascFileFrames,
   CascNameType, 
   CascOpenStorageExOptions,
+  CascOpenProgress,
+  CascReadFileResult,
+  CascStatManyResult,
+  CascVerifyProgress,
+  CascVerifyResult,
+  CascExtractProgress,
+  CascExtractResult,
+  CascNameMatchResult,
+  CascStorageStats,
+  CascFileRef,
+  CascFileRefList,
   CascStorage,
   CascFile
 } from './bindings';
@@ -36,12 +53,89 @@ export interface FileOpenOptions {
   flags?: number;
 }
 
+/**
+ * Options for opening a storage on a worker thread
+ */
+export interface OpenAsyncOptions extends CascOpenStorageExOptions {
+  /** Called for every CascLib progress message; return false to cancel */
+  onProgress?: (progress: CascOpenProgress) => boolean | void;
+  /** Cancels the open when aborted */
+  signal?: AbortSignal;
+}
+
+/**
+ * Options for reading many files at once
+ */
+export interface ReadFilesOptions {
+  /** Number of worker threads (default: number of CPU cores) */
+  concurrency?: number;
+  /** Open flags (default: CASC_OPEN_BY_NAME) */
+  flags?: number;
+  /** Files read ahead of the consumer before the workers pause (default: twice the concurrency) */
+  highWaterMark?: number;
+}
+
+/**
+ * Options for verifying storage content
+ */
+export interface VerifyOptions {
+  /** Search mask selecting the files to verify (default: "*") */
+  mask?: string;
+  /** Number of worker threads (default: number of CPU cores) */
+  threads?: number;
+  /** Optional list file path */
+  listFile?: string;
+  /** Called with throttled progress updates; return false to stop */
+  onProgress?: (progress: CascVerifyProgress) => boolean | void;
+  /** Stops the verification when aborted */
+  signal?: AbortSignal;
+}
+
+/**
+ * Options for extracting files to a directory
+ */
+export interface ExtractOptions {
+  /** Number of worker threads (default: number of CPU cores) */
+  threads?: number;
+  /** Optional list file path */
+  listFile?: string;
+  /** Called with throttled progress updates; return false to stop */
+  onProgress?: (progress: CascExtractProgress) => boolean | void;
+  /** Stops the extraction when aborted */
+  signal?: AbortSignal;
+}
+
+/**
+ * Options for creating a find iterator
+ */
+export interface FindIteratorOptions {
+  /** Maximum number of entries fetched per batch (default: 4096) */
+  batchSize?: number;
+  /** Optional list file path */
+  listFile?: string;
+}
+
+/**
+ * Options for creating a file read stream
+ */
+export interface ReadStreamOptions {
+  /** Size of each chunk read from the file (default: 65536) */
+  highWaterMark?: number;
+  /** Byte offset to start reading at (default: 0) */
+  start?: number;
+  /** Byte offset to stop reading at, inclusive (default: end of file) */
+  end?: number;
+  /** Close the file when the stream ends or is destroyed (default: false) */
+  autoClose?: boolean;
+}
+
 /**
  * CascLib Storage wrapper class
  * Provides methods to interact with CASC storage archives
  */
 export class Storage {
   private storage: CascStorage;
+  private nameIndex: Promise<number> | null = null;
 
   constructor() {
     this.storage = new CascStorageBinding();
@@ -98,20 +192,45 @@ export class Storage {
     this.storage.CascOpenStorageEx(params, options);
   }
 
+  /**
+   * Open a CASC storage on a worker thread (CascOpenStorageEx)
+   * The event loop stays free while indexes, ENCODING and ROOT are loaded.
+   * Cancellation takes effect at the next CascLib progress message and
+   * rejects the returned promise.
+   * @param params - Path or parameter string
+   * @param options - Extended opening options, progress callback and abort signal
+   * @returns Promise that resolves once the storage is open
+   */
+  async openAsync(params: string, options: OpenAsyncOptions = {}): Promise<void> {
+    const { onProgress, signal, ...openOptions } = options;
+    signal?.throwIfAborted();
+
+    await this.storage.openAsync(params, openOptions, (progress) => {
+      if (signal?.aborted) {
+        return false;
+      }
+      return onProgress ? onProgress(progress) : undefined;
+    });
+  }
+
   /**
    * Close the CASC storage
    */
   close(): boolean {
-    return this.storage.CascCloseStorage();
+    const closed = this.storage.CascCloseStorage();
+    this.nameIndex = null;
+    return closed;
   }
 
   /**
    * Open a file from the storage
-   * @param filename - Name of the file to open
+   * A 16-byte Buffer is opened as a CKey (or EKey with CASC_OPEN_BY_EKEY),
+   * a number as a FileDataId.
+   * @param filename - Name, binary key or FileDataId of the file to open
    * @param options - Optional opening options
    * @returns A File object
    */
-  openFile(filename: string, options?: FileOpenOptions): File {
+  openFile(filename: CascFileRef, options?: FileOpenOptions): File {
     const file = this.storage.CascOpenFile(filename, options?.flags || 0);
     return new File(file);
   }
@@ -127,11 +246,183 @@ export class Storage {
 
   /**
    * Check if a file exists in the storage
-   * @param filename - Name of the file
+   * @param filename - Name, binary key or FileDataId of the file
+   * @param options - Optional open flags (CASC_OPEN_BY_EKEY for EKey Buffers)
    * @returns true if file exists, false otherwise
    */
-  fileExists(filename: string): boolean {
-    return this.storage.fileExists(filename);
+  fileExists(filename: CascFileRef, options?: FileOpenOptions): boolean {
+    return this.storage.fileExists(filename, options?.flags || 0);
+  }
+
+  /**
+   * Check many files for existence in a single native call
+   * Names are resolved through the root and encoding tables without opening
+   * file handles.
+   * @param filenames - Names, a Buffer of packed 16-byte keys or a Uint32Array of FileDataIds
+   * @param options - Optional open flags (CASC_OPEN_BY_EKEY for EKey Buffers)
+   * @returns One byte per file: 1 if the file exists, 0 otherwise
+   */
+  existsMany(filenames: CascFileRefList, options?: FileOpenOptions): Uint8Array {
+    return this.storage.existsMany(filenames, options?.flags || 0);
+  }
+
+  /**
+   * Get size and keys of many files in a single native call
+   * @param filenames - Names, a Buffer of packed 16-byte keys or a Uint32Array of FileDataIds
+   * @param options - Optional open flags (CASC_OPEN_BY_EKEY for EKey Buffers)
+   * @returns Columnar result; entry i of each column belongs to file i
+   */
+  statMany(filenames: CascFileRefList, options?: FileOpenOptions): CascStatManyResult {
+    return this.storage.statMany(filenames, options?.flags || 0);
+  }
+
+  /**
+   * Read many files on a pool of worker threads
+   * Files are yielded in completion order, not input order; use `index` to
+   * map a result back to its name. Files that fail to open or read are
+   * yielded with `data: null` and an error code (see README). Breaking out of
+   * the loop stops the remaining reads.
+   * @param names - Names, a Buffer of packed 16-byte keys or a Uint32Array of FileDataIds
+   * @param options - Optional concurrency and open flags
+   * @returns Async iterator over the read results
+   */
+  async *readFiles(names: CascFileRefList, options?: ReadFilesOptions): AsyncGenerator<CascReadFileResult> {
+    const queue: CascReadFileResult[] = [];
+    let head = 0;
+    let stopped = false;
+    let finished = false;
+    let failure: unknown = null;
+    let wake: (() => void) | null = null;
+    let release = null as ((count?: number) => void) | null;
+    let held = 0;
+
+    const notify = () => {
+      const resolve = wake;
+      wake = null;
+      resolve?.();
+    };
+
+    // Workers pause once this many results are waiting to be consumed
+    const concurrency = options?.concurrency || os.cpus().length;
+    const highWaterMark = Math.max(1, options?.highWaterMark || 2 * concurrency);
+
+    const done = this.storage.readFiles(names, options?.concurrency || 0, options?.flags || 0, (result, releaseSlot) => {
+      if (stopped) {
+        return false;
+      }
+      release = releaseSlot;
+      held++;
+      queue.push(result);
+      notify();
+    }, highWaterMark);
+
+    done.then(
+      () => { finished = true; notify(); },
+      (error) => { failure = error; finished = true; notify(); }
+    );
+
+    try {
+      for (;;) {
+        if (head < queue.length) {
+          const result = queue[head];
+          queue[head++] = undefined as unknown as CascReadFileResult;
+          if (head > 1024 && head * 2 > queue.length) {
+            queue.splice(0, head);
+            head = 0;
+          }
+          // The slot is freed once the consumer asks for the next result
+          yield result;
+          held--;
+          release?.(1);
+          continue;
+        }
+        if (finished) {
+          if (failure) {
+            throw failure;
+          }
+          return;
+        }
+        await new Promise<void>((resolve) => { wake = resolve; });
+      }
+    } finally {
+      // Workers blocked on a full window need a slot to see the stop
+      stopped = true;
+      release?.(held);
+      await done.catch(() => undefined);
+    }
+  }
+
+  /**
+   * Verify the decoded content of every file matching a mask
+   * Files are decoded on a pool of worker threads with strict data checking,
+   * and the MD5 of the content is compared with the CKey. Each CKey is
+   * checked once. Stopping early resolves with `aborted: true` and the
+   * results gathered so far.
+   * @param options - Mask, thread count, progress callback and abort signal
+   * @returns Promise resolving to the verification summary
+   */
+  verifyAll(options: VerifyOptions = {}): Promise<CascVerifyResult> {
+    const { mask, threads, listFile, onProgress, signal } = options;
+
+    return this.storage.verifyAll(mask || '*', threads || 0, listFile, (progress) => {
+      if (signal?.aborted) {
+        return false;
+      }
+      return onProgress ? onProgress(progress) : undefined;
+    });
+  }
+
+  /**
+   * Extract every file matching a mask to a directory
+   * Files are decoded and written by a pool of worker threads, keeping the
+   * directory structure of their names. Output files that already have the
+   * right size and MD5 are skipped, so an interrupted run can be resumed.
+   * @param mask - Search mask selecting the files to extract
+   * @param outDir - Output directory
+   * @param options - Thread count, progress callback and abort signal
+   * @returns Promise resolving to the extraction summary
+   */
+  extract(mask: string, outDir: string, options: ExtractOptions = {}): Promise<CascExtractResult> {
+    const { threads, listFile, onProgress, signal } = options;
+
+    return this.storage.extract(mask, outDir, threads || 0, listFile, (progress) => {
+      if (signal?.aborted) {
+        return false;
+      }
+      return onProgress ? onProgress(progress) : undefined;
+    });
+  }
+
+  /**
+   * Check which candidate names the storage's root knows
+   * Every name is resolved through the root handler on a pool of worker
+   * threads, without opening files. Use this to test large
+   * community listfiles against storages that only store name hashes.
+   * Throws unless the storage has CASC_FEATURE_FNAME_HASHES.
+   * @param candidates - Array of names, or listfile content with one name per line ("id;name" lines are accepted)
+   * @param threads - Number of worker threads (default and maximum: number of CPU cores)
+   * @returns Promise resolving to a flag per candidate and the matched names
+   */
+  matchNameHashes(candidates: string[] | Buffer, threads?: number): Promise<CascNameMatchResult> {
+    return this.storage.matchNameHashes(candidates, threads || 0);
+  }
+
+  /**
+   * Get I/O and decode counters for this storage
+   * Covers storage opens, file opens and closes, lookups, reads and finds
+   * made through this storage and the files and iterators opened from it.
+   * The counters are atomic and cheap enough to leave on.
+   * @returns Counters and timing histograms
+   */
+  getStats(): CascStorageStats {
+    return this.storage.getStats();
+  }
+
+  /**
+   * Reset all counters returned by getStats()
+   */
+  resetStats(): void {
+    this.storage.resetStats();
   }
 
   /**
@@ -169,6 +460,74 @@ export class Storage {
     return this.storage.CascFindClose();
   }
 
+  /**
+   * Find files in columnar batches
+   * Passing a mask starts a new search (closing any search in progress);
+   * passing null continues the current one. Uses the same search state as
+   * findFirstFile/findNextFile.
+   * @param mask - File mask (e.g., "*.txt"), or null to continue
+   * @param maxEntries - Maximum number of entries per batch (default: 4096)
+   * @param listFile - Optional list file path
+   * @returns Batch of find data or null if no more files
+   */
+  findBatch(mask?: string | null, maxEntries?: number, listFile?: string): CascFindBatch | null {
+    return this.storage.findBatch(mask, maxEntries, listFile);
+  }
+
+  /**
+   * Create an independent find iterator
+   * Each iterator owns its own search handle, so several masks can be
+   * enumerated at the same time. The next batch is fetched on a worker
+   * thread while the current one is consumed.
+   * @param mask - File mask (default: "*")
+   * @param options - Optional batch size and list file
+   * @returns A FindIterator
+   */
+  createFindIterator(mask?: string, options?: FindIteratorOptions): FindIterator {
+    const iterator = this.storage.createFindIterator(mask || '*', options?.batchSize || 0, options?.listFile);
+    return new FindIterator(iterator);
+  }
+
+  /**
+   * Build the sorted name index used by findPrefix() and listDirectory()
+   * The storage is enumerated once on a worker thread and only the names are
+   * kept, until close. Later calls return the same Promise.
+   * @returns Promise resolving with the number of distinct names
+   */
+  buildNameIndex(): Promise<number> {
+    if (!this.nameIndex) {
+      this.nameIndex = this.storage.buildNameIndex().catch((error) => {
+        this.nameIndex = null;
+        throw error;
+      });
+    }
+    return this.nameIndex;
+  }
+
+  /**
+   * Find every file whose name starts with a prefix
+   * Matching ignores case and treats backslashes and slashes alike. Waits
+   * for buildNameIndex(), then only visits matching names.
+   * @param prefix - Name prefix (e.g., "mods/core.stormmod/")
+   * @returns Matching names in name order (empty if no file matches)
+   */
+  async findPrefix(prefix: string): Promise<string[]> {
+    await this.buildNameIndex();
+    return this.storage.findPrefix(prefix);
+  }
+
+  /**
+   * List the direct subdirectories and files of a directory
+   * Uses the same sorted names as findPrefix(), so each call skips over the
+   * content of subdirectories instead of scanning it.
+   * @param path - Directory path (default: the root)
+   * @returns Names of the subdirectories and files, relative to the directory
+   */
+  async listDirectory(path?: string): Promise<CascDirectoryListing> {
+    await this.buildNameIndex();
+    return this.storage.listDirectory(path || '');
+  }
+
   /**
    * Add an encryption key to the storage
    * @param keyName - Name/ID of the key
@@ -225,6 +584,59 @@ export class Storage {
   }
 }
 
+/**
+ * Asynchronous file enumeration with its own search handle
+ * Iterate with `for await` to get one CascFindData per file, or use
+ * batches() for the columnar form. The search handle is closed when
+ * iteration ends or is broken off.
+ */
+export class FindIterator implements AsyncIterable<CascFindData> {
+  private iterator: CascFindIterator;
+
+  constructor(iterator: CascFindIterator) {
+    this.iterator = iterator;
+  }
+
+  /**
+   * Get the next batch of entries
+   * @returns Promise resolving to a batch or null when the search is done
+   */
+  nextBatch(): Promise<CascFindBatch | null> {
+    return this.iterator.nextBatch();
+  }
+
+  /**
+   * Iterate over the remaining entries in columnar batches
+   */
+  async *batches(): AsyncGenerator<CascFindBatch> {
+    try {
+      let batch = await this.iterator.nextBatch();
+      while (batch) {
+        yield batch;
+        batch = await this.iterator.nextBatch();
+      }
+    } finally {
+      this.close();
+    }
+  }
+
+  async *[Symbol.asyncIterator](): AsyncGenerator<CascFindData> {
+    for await (const batch of this.batches()) {
+      for (let i = 0; i < batch.count; i++) {
+        yield getFindBatchEntry(batch, i);
+      }
+    }
+  }
+
+  /**
+   * Close the search handle
+   * @returns true if closed by this call
+   */
+  close(): boolean {
+    return this.iterator.CascFindClose();
+  }
+}
+
 /**
  * CascLib File wrapper class
  * Represents an open file in CASC storage
@@ -253,6 +665,106 @@ export class File {
     return this.file.readFileAll();
   }
 
+  /**
+   * Read data from the current position into a caller-supplied buffer
+   * The target can be reused across files to avoid an allocation per read.
+   * @param target - Buffer, TypedArray or ArrayBuffer to fill
+   * @param offset - Byte offset in the target to start writing at (default: 0)
+   * @param length - Maximum number of bytes to read (default: rest of the target)
+   * @returns Number of bytes read
+   */
+  readInto(target: Buffer | ArrayBufferView | ArrayBuffer, offset?: number, length?: number): number {
+    return this.file.readFileInto(target, offset || 0, length);
+  }
+
+  /**
+   * Read data from the file on a worker thread
+   * Only one asynchronous operation may be pending per file; other calls
+   * on the same file throw until the returned promise settles.
+   * @param bytesToRead - Number of bytes to read (default: 4096)
+   * @returns Promise resolving to a Buffer containing the read data
+   */
+  readAsync(bytesToRead?: number): Promise<Buffer> {
+    return this.file.readFileAsync(bytesToRead || 4096);
+  }
+
+  /**
+   * Read all data from the file on a worker thread
+   * @returns Promise resolving to a Buffer containing all file data
+   */
+  readAllAsync(): Promise<Buffer> {
+    return this.file.readFileAllAsync();
+  }
+
+  /**
+   * Read a range of the file without using the file position
+   * Each call uses a private handle, so calls never affect read() or each
+   * other. Only the frames that overlap the range are decoded.
+   * @param offset - Byte offset to start reading at (64-bit)
+   * @param length - Number of bytes to read
+   * @returns Buffer with the data; shorter than length at the end of the file
+   */
+  readAt(offset: number, length: number): Buffer {
+    return this.file.readFileAt(offset, length);
+  }
+
+  /**
+   * Read a range of the file on a worker thread
+   * Any number of calls may be pending on the same file, and they may run
+   * alongside other operations on it.
+   * @param offset - Byte offset to start reading at (64-bit)
+   * @param length - Number of bytes to read
+   * @returns Promise resolving to a Buffer with the data
+   */
+  readAtAsync(offset: number, length: number): Promise<Buffer> {
+    return this.file.readFileAtAsync(offset, length);
+  }
+
+  /**
+   * Get the BLTE frames of the file
+   * Content offsets are relative to the file; encoded offsets are relative
+   * to the data file. Modes are character codes ('N', 'Z', '4', 'F', 'E'),
+   * or 0 where the data file is not available locally.
+   * @returns Columnar frame metadata
+   */
+  getFrames(): CascFileFrames {
+    return this.file.getFileFrames();
+  }
+
+  /**
+   * Decode a run of frames without using the file position
+   * Only the requested frames are read and decoded, which suits random
+   * access into large multi-span files.
+   * @param first - Index of the first frame, as in getFrames()
+   * @param count - Number of frames to decode
+   * @returns Buffer with the decoded content of the frames
+   */
+  readFrames(first: number, count: number): Buffer {
+    return this.file.readFileFrames(first, count);
+  }
+
+  /**
+   * Decode a run of frames on a worker thread
+   * @param first - Index of the first frame, as in getFrames()
+   * @param count - Number of frames to decode
+   * @returns Promise resolving to a Buffer with the decoded content
+   */
+  readFramesAsync(first: number, count: number): Promise<Buffer> {
+    return this.file.readFileFramesAsync(first, count);
+  }
+
+  /**
+   * Create a Readable stream over the file
+   * Chunks are decoded on a worker thread; the next chunk is read while the
+   * current one is consumed. The file is busy until the stream ends or is
+   * destroyed, so other calls on it throw in the meantime.
+   * @param options - Stream options
+   * @returns Readable stream of Buffers
+   */
+  createReadStream(options?: ReadStreamOptions): FileReadStream {
+    return new FileReadStream(this, options);
+  }
+
   /**
    * Get the file size (32-bit)
    * @returns File size in bytes
@@ -331,12 +843,156 @@ export class File {
   }
 }
 
+/**
+ * Readable stream over a CASC file
+ * Keeps one read in flight ahead of the consumer. Memory stays bounded by
+ * the stream buffer plus one chunk, because no further read is started
+ * until the stream asks for more data.
+ */
+export class FileReadStream extends Readable {
+  private file: File;
+  private position: number;
+  private end: number;
+  private chunkSize: number;
+  private autoClose: boolean;
+  private pending: Promise<Buffer> | null = null;
+  private inflight: Promise<unknown> | null = null;
+
+  constructor(file: File, options: ReadStreamOptions = {}) {
+    const chunkSize = options.highWaterMark || 64 * 1024;
+    super({ highWaterMark: chunkSize });
+
+    const size = file.getSize64();
+    const start = options.start || 0;
+    const end = options.end !== undefined ? Math.min(options.end, size - 1) : size - 1;
+
+    if (start < 0 || !Number.isSafeInteger(start)) {
+      throw new RangeError('start must be a non-negative integer');
+    }
+    if (!Number.isSafeInteger(end) || end < start - 1) {
+      throw new RangeError('end must be an integer not less than start');
+    }
+
+    this.file = file;
+    this.position = start;
+    this.end = end;
+    this.chunkSize = chunkSize;
+    this.autoClose = options.autoClose || false;
+
+    file.setPosition64(start);
+  }
+
+  private fetch(): Promise<Buffer> | null {
+    const remaining = this.end + 1 - this.position;
+    if (remaining <= 0) {
+      return null;
+    }
+
+    const pending = this.file.readAsync(Math.min(this.chunkSize, remaining));
+    // Errors are reported when the chunk is consumed
+    const settled = pending.then(() => {}, () => {});
+    this.inflight = settled;
+    settled.then(() => {
+      if (this.inflight === settled) {
+        this.inflight = null;
+      }
+    });
+    return pending;
+  }
+
+  async _read(): Promise<void> {
+    try {
+      const pending = this.pending || this.fetch();
+      this.pending = null;
+
+      const chunk = pending ? await pending : null;
+      if (!chunk || chunk.length === 0) {
+        this.push(null);
+        return;
+      }
+
+      // Start decoding the next chunk before handing this one over
+      this.position += chunk.length;
+      this.pending = this.fetch();
+      this.push(chunk);
+    } catch (err) {
+      this.destroy(err as Error);
+    }
+  }
+
+  _destroy(err: Error | null, callback: (error?: Error | null) => void): void {
+    const inflight = this.inflight;
+    this.pending = null;
+
+    // The file stays busy until the read in flight settles
+    const finish = () => {
+      if (this.autoClose) {
+        try {
+          this.file.close();
+        } catch (closeErr) {
+          err = err || (closeErr as Error);
+        }
+      }
+      callback(err);
+    };
+
+    if (inflight) {
+      inflight.then(finish);
+    } else {
+      finish();
+    }
+  }
+}
+
+/**
+ * Get the file name of an entry in a find batch
+ * @param batch - Batch returned by findBatch
+ * @param index - Entry index within the batch
+ * @returns The file name
+ */
+export function getFindBatchName(batch: CascFindBatch, index: number): string {
+  return batch.names.toString('utf8', batch.nameOffsets[index], batch.nameOffsets[index + 1]);
+}
+
+/**
+ * Get an entry of a find batch as a CascFindData object
+ * The key Buffers are views into the batch, not copies.
+ * @param batch - Batch returned by findBatch or a FindIterator
+ * @param index - Entry index within the batch
+ * @returns The find data for the entry
+ */
+export function getFindBatchEntry(batch: CascFindBatch, index: number): CascFindData {
+  const fileName = getFindBatchName(batch, index);
+  const keyOffset = index * 16;
+  const separator = Math.max(fileName.lastIndexOf('\\'), fileName.lastIndexOf('/'));
+
+  return {
+    fileName,
+    ckey: batch.ckeys.subarray(keyOffset, keyOffset + 16),
+    ekey: batch.ekeys.subarray(keyOffset, keyOffset + 16),
+    tagBitMask: batch.tagBitMasks[index],
+    fileSize: batch.fileSizes[index],
+    plainName: fileName.substring(separator + 1),
+    fileDataId: batch.fileDataIds[index],
+    localeFlags: batch.localeFlags[index],
+    contentFlags: batch.contentFlags[index],
+    spanCount: batch.spanCounts[index],
+    available: batch.available[index] !== 0,
+    nameType: batch.nameTypes[index] as CascNameType,
+  };
+}
+
+export * from './cdn';
+export * from './onlinecache';
+
 // Re-export everything from bindings
 export * from './bindings';
 
 // High-level exports
 export default {
   Storage,
-  File
+  File,
+  FileReadStream,
+  FindIterator
 };
 
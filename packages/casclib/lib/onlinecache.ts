@@ -0,0 +1,485 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { decodeBlteSync } from './cdn';
+
+const MANIFEST_NAME = '.casclib-cache.json';
+const MANIFEST_VERSION = 1;
+
+/**
+ * Options for an OnlineCache
+ */
+export interface OnlineCacheOptions {
+  /** Byte budget for the cache folder */
+  maxBytes: number;
+  /** Build config key of the build to protect (default: the most recently used build config) */
+  buildKey?: string;
+  /** CDN config key of the build to protect (default: the most recently used CDN config) */
+  cdnKey?: string;
+}
+
+/**
+ * Counters returned by OnlineCache.getStats()
+ */
+export interface OnlineCacheStats {
+  files: number;
+  bytes: number;
+  maxBytes: number;
+  protectedFiles: number;   // Files the current build needs; never evicted
+  protectedBytes: number;
+  reusedFiles: number;      // Cached files whose access time moved (see getStats)
+  downloadedFiles: number;  // Files that appeared in the folder
+  downloadedBytes: number;
+  hits: number;             // Reads served from the folder, as recorded by recordRead()
+  misses: number;           // Reads that had to be downloaded
+  hitRate: number;          // hits / (hits + misses), 0 before the first read
+  evictedFiles: number;
+  evictedBytes: number;
+}
+
+// Build config lines whose keys name files directly; any other single key is a CKey
+const DIRECT_KEY_LINES = new Set(['patch', 'patch-config']);
+
+// What the manifest remembers about one cached file
+interface CacheEntry {
+  size: number;
+  lastAccess: number;  // ms since the epoch
+  config?: string;     // 'build' or 'cdn' for config files, '' for anything else
+}
+
+const KEY_PATTERN = /^[0-9a-f]{32}$/;
+
+// Keys of cached files are their base names without extension
+function getKey(file: string): string {
+  return path.basename(file).split('.')[0].toLowerCase();
+}
+
+// Reads a file without moving its access time, so that the manager's own
+// reads are not counted as reuse or keep old builds alive
+function readUntouched(file: string, length?: number): Buffer {
+  const stat = fs.statSync(file);
+  const fd = fs.openSync(file, 'r');
+  try {
+    const buffer = Buffer.alloc(Math.min(length ?? stat.size, stat.size));
+    const bytesRead = fs.readSync(fd, buffer, 0, buffer.length, 0);
+    return buffer.subarray(0, bytesRead);
+  } finally {
+    fs.closeSync(fd);
+    fs.utimesSync(file, stat.atime, stat.mtime);
+  }
+}
+
+// Kind of a config file from its first line
+function getConfigKind(file: string, size: number): string {
+  if (!KEY_PATTERN.test(getKey(file)) || path.extname(file) !== '' || size > 0x100000) {
+    return '';
+  }
+  let head: string;
+  try {
+    head = readUntouched(file, 32).toString('utf8');
+  } catch {
+    return '';
+  }
+  return head.startsWith('# Build Configuration') ? 'build' : head.startsWith('# CDN Configuration') ? 'cdn' : '';
+}
+
+/**
+ * Look up the EKeys of CKeys in a decoded ENCODING file
+ * The CKey table is split into pages; a table of the first CKey of every
+ * page is searched first, then the one page that can hold the CKey.
+ * @param encoding - Decoded ENCODING content
+ * @param ckeys - CKeys as lowercase hex
+ * @returns The first EKey of each CKey that was found, as lowercase hex
+ */
+function findEncodingKeys(encoding: Buffer, ckeys: string[]): string[] {
+  if (encoding.length < 22 || encoding.toString('latin1', 0, 2) !== 'EN') {
+    return [];
+  }
+
+  const ckeySize = encoding[3];
+  const ekeySize = encoding[4];
+  const pageSize = encoding.readUInt16BE(5) * 1024;
+  const pageCount = encoding.readUInt32BE(9);
+  const tableStart = 22 + encoding.readUInt32BE(18);
+  const pagesStart = tableStart + pageCount * (ckeySize + 16);
+  const ekeys: string[] = [];
+
+  for (const hex of ckeys) {
+    const ckey = Buffer.from(hex, 'hex');
+
+    // Last page whose first CKey is not above the one looked for
+    let low = 0;
+    let high = pageCount - 1;
+    let page = -1;
+    while (low <= high) {
+      const middle = (low + high) >>> 1;
+      const first = tableStart + middle * (ckeySize + 16);
+      if (encoding.compare(ckey, 0, ckeySize, first, first + ckeySize) <= 0) {
+        page = middle;
+        low = middle + 1;
+      } else {
+        high = middle - 1;
+      }
+    }
+    if (page < 0) {
+      continue;
+    }
+
+    // Entries: key count, 40-bit content size, CKey, then that many EKeys
+    let position = pagesStart + page * pageSize;
+    const end = Math.min(position + pageSize, encoding.length);
+    while (position + 6 + ckeySize + ekeySize <= end && encoding[position] !== 0) {
+      const keyCount = encoding[position];
+      if (encoding.compare(ckey, 0, ckeySize, position + 6, position + 6 + ckeySize) === 0) {
+        ekeys.push(encoding.toString('hex', position + 6 + ckeySize, position + 6 + ckeySize + ekeySize));
+        break;
+      }
+      position += 6 + ckeySize + keyCount * ekeySize;
+    }
+  }
+
+  return ekeys;
+}
+
+/**
+ * Keeps the cache folder of an online storage under a byte budget
+ *
+ * CascLib reads and writes the cache folder itself, so the manager works from
+ * the folder's content. refresh() scans it: files that appeared since the
+ * last scan count as downloaded, and files whose access time moved count as
+ * reused. trim() deletes the least recently used files until the folder fits
+ * the budget. The files the current build needs are never deleted: its
+ * configs, the archives and indexes of its CDN config, and the EKeys of its
+ * ENCODING, root, install, download and other manifests. Files that are not
+ * named by a key (versions, cdns and other bookkeeping files) are kept too.
+ * The current build is taken from the options or from the most recently
+ * used build and CDN configs.
+ *
+ * Cached files are named by EKey, while a build config lists most
+ * manifests by CKey. Lines with a CKey and EKey pair protect the EKey;
+ * a CKey on its own (root) is looked up in the build's ENCODING file.
+ *
+ * Reads that CascLib serves from the folder are not visible here, so the hit
+ * rate comes from the code that serves reads: a CdnArchiveReader given this
+ * cache as its onlineCache option records each range it reads as a hit or a
+ * miss.
+ *
+ * Access times need a filesystem that records them. With relatime (the
+ * Linux default), a file's access time is refreshed about once a day,
+ * which is enough to order builds for eviction.
+ */
+export class OnlineCache {
+  private dir: string;
+  private options: OnlineCacheOptions;
+  private entries = new Map<string, CacheEntry>();
+  private protectedKeys = new Set<string>();
+  private resolved = new Map<string, string[]>();  // Build config key -> EKeys of its lone CKeys
+  private stats: OnlineCacheStats;
+  private baseline: boolean;
+
+  /**
+   * @param dir - The local cache folder of the online storage
+   * @param options - Byte budget and optional build to protect
+   */
+  constructor(dir: string, options: OnlineCacheOptions) {
+    if (!(options.maxBytes >= 0)) {
+      throw new RangeError('maxBytes must not be negative');
+    }
+
+    this.dir = path.resolve(dir);
+    this.options = options;
+    this.stats = {
+      files: 0, bytes: 0, maxBytes: options.maxBytes, protectedFiles: 0, protectedBytes: 0,
+      reusedFiles: 0, downloadedFiles: 0, downloadedBytes: 0, hits: 0, misses: 0, hitRate: 0, evictedFiles: 0, evictedBytes: 0
+    };
+    this.baseline = !this.loadManifest();
+  }
+
+  /**
+   * Scan the cache folder and count reused and downloaded files since the last scan
+   * The first scan of a folder without a manifest only records its content.
+   * @returns Updated counters
+   */
+  refresh(): OnlineCacheStats {
+    const seen = new Map<string, CacheEntry>();
+    let reused = 0;
+    let downloaded = 0;
+    let downloadedBytes = 0;
+
+    for (const file of this.listFiles()) {
+      let stat: fs.Stats;
+      try {
+        stat = fs.statSync(path.join(this.dir, file));
+      } catch {
+        continue;
+      }
+
+      const lastAccess = Math.max(stat.atimeMs, stat.mtimeMs);
+      const previous = this.entries.get(file);
+      if (!previous) {
+        downloaded++;
+        downloadedBytes += stat.size;
+      } else if (lastAccess > previous.lastAccess) {
+        reused++;
+      }
+
+      const changed = !previous || previous.size !== stat.size || previous.config === undefined;
+      const config = changed ? getConfigKind(path.join(this.dir, file), stat.size) : previous.config;
+      seen.set(file, { size: stat.size, lastAccess, config });
+    }
+
+    if (this.baseline) {
+      reused = downloaded = downloadedBytes = 0;
+      this.baseline = false;
+    }
+
+    this.entries = seen;
+    this.stats.reusedFiles += reused;
+    this.stats.downloadedFiles += downloaded;
+    this.stats.downloadedBytes += downloadedBytes;
+    this.updateProtected();
+    this.updateTotals();
+    this.saveManifest();
+    return this.getStats();
+  }
+
+  /**
+   * Delete the least recently used files until the folder fits the budget
+   * @returns Updated counters
+   */
+  trim(): OnlineCacheStats {
+    this.refresh();
+
+    const candidates = [...this.entries.entries()]
+      .filter(([file]) => !this.isProtected(file))
+      .sort((a, b) => a[1].lastAccess - b[1].lastAccess);
+
+    let bytes = this.stats.bytes;
+    for (const [file, entry] of candidates) {
+      if (bytes <= this.options.maxBytes) {
+        break;
+      }
+
+      try {
+        fs.unlinkSync(path.join(this.dir, file));
+      } catch {
+        continue;
+      }
+
+      this.entries.delete(file);
+      bytes -= entry.size;
+      this.stats.evictedFiles++;
+      this.stats.evictedBytes += entry.size;
+      this.removeEmptyDirs(path.dirname(path.join(this.dir, file)));
+    }
+
+    this.updateTotals();
+    this.saveManifest();
+    return this.getStats();
+  }
+
+  /**
+   * Get cache size, protection and reuse counters as of the last scan
+   *
+   * reusedFiles counts files whose access time moved between two scans, not
+   * reads. A file read many times between scans counts once, and under
+   * relatime (the Linux default) a file's access time moves at most once a
+   * day, so most re-reads are not seen at all. With noatime, nothing counts
+   * as reused. Use it to see which cached files are still in use. hits,
+   * misses and hitRate count the reads recorded with recordRead().
+   */
+  getStats(): OnlineCacheStats {
+    const reads = this.stats.hits + this.stats.misses;
+    return { ...this.stats, hitRate: reads ? this.stats.hits / reads : 0 };
+  }
+
+  /**
+   * Count one read served from the cache folder (hit) or downloaded into it (miss)
+   * Called by the code that serves reads; a CdnArchiveReader given this
+   * cache as its onlineCache option records every range read.
+   * @param hit - Whether the read was served from the folder
+   */
+  recordRead(hit: boolean): void {
+    if (hit) {
+      this.stats.hits++;
+    } else {
+      this.stats.misses++;
+    }
+  }
+
+  /**
+   * Reset the reuse, download, read and eviction counters
+   */
+  resetStats(): void {
+    Object.assign(this.stats, {
+      reusedFiles: 0, downloadedFiles: 0, downloadedBytes: 0, hits: 0, misses: 0, evictedFiles: 0, evictedBytes: 0
+    });
+  }
+
+  // Relative paths of all files in the cache folder, except the manifest
+  private listFiles(): string[] {
+    const files: string[] = [];
+    const walk = (relative: string) => {
+      let names: fs.Dirent[];
+      try {
+        names = fs.readdirSync(path.join(this.dir, relative), { withFileTypes: true });
+      } catch {
+        return;
+      }
+      for (const entry of names) {
+        const child = relative ? path.join(relative, entry.name) : entry.name;
+        if (entry.isDirectory()) {
+          walk(child);
+        } else if (entry.isFile() && child !== MANIFEST_NAME && !entry.name.endsWith('.tmp')) {
+          files.push(child);
+        }
+      }
+    };
+    walk('');
+    return files;
+  }
+
+  private isProtected(file: string): boolean {
+    const key = getKey(file);
+    return !KEY_PATTERN.test(key) || this.protectedKeys.has(key);
+  }
+
+  // Finds the current build and CDN configs and collects the EKeys of the files they need
+  private updateProtected(): void {
+    const pick = (kind: string, wanted?: string) => [...this.entries.entries()]
+      .filter(([file, entry]) => entry.config === kind && (!wanted || getKey(file) === wanted.toLowerCase()))
+      .sort((a, b) => b[1].lastAccess - a[1].lastAccess)[0];
+
+    this.protectedKeys = new Set<string>();
+    for (const config of [pick('build', this.options.buildKey), pick('cdn', this.options.cdnKey)]) {
+      if (!config) {
+        continue;
+      }
+
+      let text: string;
+      try {
+        text = readUntouched(path.join(this.dir, config[0])).toString('utf8');
+      } catch {
+        continue;
+      }
+
+      const configKey = getKey(config[0]);
+      const isBuild = config[1].config === 'build';
+      const lone: string[] = [];
+      let encodingKey: string | null = null;
+      this.protectedKeys.add(configKey);
+
+      for (const line of text.split(/\r?\n/)) {
+        const separator = line.indexOf('=');
+        if (separator < 0 || line.startsWith('#')) {
+          continue;
+        }
+
+        const name = line.substring(0, separator).trim();
+        const keys = line.substring(separator + 1).trim().split(/\s+/)
+          .map((word) => word.toLowerCase())
+          .filter((word) => KEY_PATTERN.test(word));
+
+        if (!isBuild || DIRECT_KEY_LINES.has(name)) {
+          keys.forEach((key) => this.protectedKeys.add(key));
+        } else if (keys.length === 1) {
+          lone.push(keys[0]);
+        } else {
+          // CKey EKey pairs; only the EKeys name cached files
+          for (let i = 1; i < keys.length; i += 2) {
+            this.protectedKeys.add(keys[i]);
+          }
+          if (name === 'encoding') {
+            encodingKey = keys[1];
+          }
+        }
+      }
+
+      for (const ekey of this.resolveLoneKeys(configKey, encodingKey, lone)) {
+        this.protectedKeys.add(ekey);
+      }
+    }
+  }
+
+  // EKeys of a build's lone CKeys (root, and older install or download lines)
+  // from its cached ENCODING file. Remembered per build, so ENCODING is only
+  // decoded again when the build changes.
+  private resolveLoneKeys(configKey: string, encodingKey: string | null, ckeys: string[]): string[] {
+    const known = this.resolved.get(configKey);
+    if (known || ckeys.length === 0 || !encodingKey) {
+      return known ?? [];
+    }
+
+    const encodingFile = [...this.entries.keys()].find((file) => getKey(file) === encodingKey);
+    if (!encodingFile) {
+      return [];
+    }
+
+    let ekeys: string[];
+    try {
+      ekeys = findEncodingKeys(decodeBlteSync(readUntouched(path.join(this.dir, encodingFile))), ckeys);
+    } catch {
+      return [];
+    }
+
+    this.resolved.set(configKey, ekeys);
+    return ekeys;
+  }
+
+  private updateTotals(): void {
+    let bytes = 0;
+    let protectedFiles = 0;
+    let protectedBytes = 0;
+
+    for (const [file, entry] of this.entries) {
+      bytes += entry.size;
+      if (this.isProtected(file)) {
+        protectedFiles++;
+        protectedBytes += entry.size;
+      }
+    }
+
+    Object.assign(this.stats, { files: this.entries.size, bytes, protectedFiles, protectedBytes });
+  }
+
+  private removeEmptyDirs(dir: string): void {
+    while (dir.startsWith(this.dir + path.sep)) {
+      try {
+        fs.rmdirSync(dir);
+      } catch {
+        return;
+      }
+      dir = path.dirname(dir);
+    }
+  }
+
+  // Returns false when there is no usable manifest yet
+  private loadManifest(): boolean {
+    try {
+      const manifest = JSON.parse(fs.readFileSync(path.join(this.dir, MANIFEST_NAME), 'utf8'));
+      if (manifest.version === MANIFEST_VERSION) {
+        this.entries = new Map(Object.entries(manifest.entries as Record<string, CacheEntry>));
+        this.resolved = new Map(Object.entries((manifest.resolved ?? {}) as Record<string, string[]>));
+        return true;
+      }
+    } catch {
+      // Missing or unreadable
+    }
+    return false;
+  }
+
+  private saveManifest(): void {
+    const manifestPath = path.join(this.dir, MANIFEST_NAME);
+    const manifest = {
+      version: MANIFEST_VERSION,
+      entries: Object.fromEntries(this.entries),
+      resolved: Object.fromEntries(this.resolved)
+    };
+    try {
+      fs.mkdirSync(this.dir, { recursive: true });
+      fs.writeFileSync(`${manifestPath}.tmp`, JSON.stringify(manifest));
+      fs.renameSync(`${manifestPath}.tmp`, manifestPath);
+    } catch {
+      // The cache folder is not writable; counters stay in memory
+    }
+  }
+}
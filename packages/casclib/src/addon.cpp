@@ -2,6 +2,9 @@
 #include <string>
 #include "storage.h"
 #include "file.h"
+#include "find.h"
+#include "cache.h"
+#include "workers.h"
 #include "CascLib.h"
 #include "CascCommon.h"
 
@@ -101,11 +104,103 @@ Napi::Value CdnDownload(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  // Copy the data to a Node.js Buffer and free the original
-  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, data, dwSize);
-  CascCdnFree(data);
-  
-  return buffer;
+  // The Buffer takes over the downloaded memory and frees it with CascCdnFree
+  return TakeCdnBuffer(env, data, dwSize);
+}
+
+// Downloads many CDN files on a pool of threads; returns one Promise per item
+Napi::Value CdnDownloadMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of { host, product, path } objects as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array array = info[0].As<Napi::Array>();
+  std::vector<CdnDownloadItem> items;
+  items.reserve(array.Length());
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value value = array.Get(i);
+    Napi::Object object = value.IsObject() ? value.As<Napi::Object>() : Napi::Object();
+
+    if (object.IsEmpty() || !object.Get("host").IsString() || !object.Get("product").IsString() ||
+        !object.Get("path").IsString()) {
+      Napi::TypeError::New(env, "Each item must have host, product and path strings")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    items.push_back({
+      object.Get("host").As<Napi::String>().Utf8Value(),
+      object.Get("product").As<Napi::String>().Utf8Value(),
+      object.Get("path").As<Napi::String>().Utf8Value()
+    });
+  }
+
+  size_t concurrency = 8;
+  if (info.Length() > 1 && info[1].IsObject()) {
+    Napi::Object options = info[1].As<Napi::Object>();
+    if (options.Has("concurrency") && options.Get("concurrency").IsNumber()) {
+      double value = options.Get("concurrency").As<Napi::Number>().DoubleValue();
+      if (!(value >= 1)) {
+        Napi::RangeError::New(env, "Concurrency must be at least 1")
+          .ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      concurrency = (size_t)value;
+    }
+  }
+
+  CdnDownloadManyWorker* worker = new CdnDownloadManyWorker(env, std::move(items), concurrency);
+  Napi::Array promises = worker->GetPromises();
+  worker->Queue();
+  return promises;
+}
+
+// Sets the byte budget of the content cache; 0 disables it
+Napi::Value SetContentCacheLimit(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected byte limit as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double limit = info[0].As<Napi::Number>().DoubleValue();
+  if (!(limit >= 0)) {
+    Napi::RangeError::New(env, "Byte limit must not be negative")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  ContentCache::Instance().SetLimit((uint64_t)limit);
+  return env.Undefined();
+}
+
+// Returns the content cache counters
+Napi::Value GetContentCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ContentCacheStats stats = ContentCache::Instance().GetStats();
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("hits", Napi::Number::New(env, (double)stats.hits));
+  result.Set("misses", Napi::Number::New(env, (double)stats.misses));
+  result.Set("evictions", Napi::Number::New(env, (double)stats.evictions));
+  result.Set("insertions", Napi::Number::New(env, (double)stats.insertions));
+  result.Set("entries", Napi::Number::New(env, (double)stats.entries));
+  result.Set("bytes", Napi::Number::New(env, (double)stats.bytes));
+  result.Set("limit", Napi::Number::New(env, (double)stats.limit));
+  return result;
+}
+
+// Drops every cached entry; Buffers already handed out stay valid
+Napi::Value ClearContentCache(const Napi::CallbackInfo& info) {
+  ContentCache::Instance().Clear();
+  return info.Env().Undefined();
 }
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
@@ -115,6 +210,9 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
   // Initialize File class  
   CascFile::Init(env, exports);
 
+  // Initialize FindIterator class
+  CascFindIterator::Init(env, exports);
+
   // Export utility functions
   exports.Set("CascOpenLocalFile", Napi::Function::New(env, OpenLocalFile));
   exports.Set("GetCascError", Napi::Function::New(env, GetError));
@@ -123,6 +221,12 @@ Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
   // Export CDN functions
   exports.Set("CascCdnGetDefault", Napi::Function::New(env, CdnGetDefault));
   exports.Set("CascCdnDownload", Napi::Function::New(env, CdnDownload));
+  exports.Set("cdnDownloadMany", Napi::Function::New(env, CdnDownloadMany));
+
+  // Export content cache functions
+  exports.Set("setContentCacheLimit", Napi::Function::New(env, SetContentCacheLimit));
+  exports.Set("getContentCacheStats", Napi::Function::New(env, GetContentCacheStats));
+  exports.Set("clearContentCache", Napi::Function::New(env, ClearContentCache));
 
   // Export version constants
   exports.Set("CASCLIB_VERSION", Napi::Number::New(env, CASCLIB_VERSION));
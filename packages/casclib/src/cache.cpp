@@ -0,0 +1,154 @@
+#include "cache.h"
+#include "CascCommon.h"
+#include <cstdlib>
+
+ContentCache& ContentCache::Instance() {
+  static ContentCache instance;
+  return instance;
+}
+
+ContentCache::ContentCache()
+  : limit(0), bytes(0), hits(0), misses(0), evictions(0), insertions(0) {
+}
+
+bool ContentCache::IsEnabled() {
+  std::lock_guard<std::mutex> guard(lock);
+  return limit > 0;
+}
+
+bool ContentCache::Accepts(uint64_t size) {
+  std::lock_guard<std::mutex> guard(lock);
+  return size <= limit;
+}
+
+void ContentCache::SetLimit(uint64_t newLimit) {
+  std::lock_guard<std::mutex> guard(lock);
+  limit = newLimit;
+  EvictLocked(limit);
+}
+
+void ContentCache::Clear() {
+  std::lock_guard<std::mutex> guard(lock);
+  lru.clear();
+  entries.clear();
+  bytes = 0;
+}
+
+ContentCacheStats ContentCache::GetStats() {
+  std::lock_guard<std::mutex> guard(lock);
+  ContentCacheStats stats = { hits, misses, evictions, insertions, (uint64_t)entries.size(), bytes, limit };
+  return stats;
+}
+
+ContentBlockPtr ContentCache::Find(const BYTE* ckey) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto it = entries.find(std::string(reinterpret_cast<const char*>(ckey), MD5_HASH_SIZE));
+
+  if (it == entries.end()) {
+    misses++;
+    return nullptr;
+  }
+
+  hits++;
+  lru.splice(lru.begin(), lru, it->second);
+  return it->second->block;
+}
+
+void ContentCache::Insert(const BYTE* ckey, const ContentBlockPtr& block) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::string key(reinterpret_cast<const char*>(ckey), MD5_HASH_SIZE);
+
+  // Blocks larger than the whole budget would only flush the cache
+  if (block->size > limit || entries.count(key) != 0) {
+    return;
+  }
+
+  EvictLocked(limit - block->size);
+
+  lru.push_front(Entry{ key, block });
+  entries[key] = lru.begin();
+  bytes += block->size;
+  insertions++;
+}
+
+void ContentCache::EvictLocked(uint64_t target) {
+  while (bytes > target && !lru.empty()) {
+    Entry& entry = lru.back();
+    bytes -= entry.block->size;
+    entries.erase(entry.key);
+    lru.pop_back();
+    evictions++;
+  }
+}
+
+ContentBlockPtr CascReadFileCached(HANDLE hFile, CascStats* stats) {
+  ContentCache& cache = ContentCache::Instance();
+  CASC_FILE_FULL_INFO fileInfo = {0};
+  ULONGLONG position = 0;
+
+  if (!cache.IsEnabled()) {
+    return nullptr;
+  }
+
+  // Only whole reads from the start map to the CKey content
+  if (!CascSetFilePointer64(hFile, 0, &position, FILE_CURRENT) || position != 0) {
+    return nullptr;
+  }
+
+  if (!CascGetFileInfo(hFile, CascFileFullInfo, &fileInfo, sizeof(fileInfo), nullptr)) {
+    return nullptr;
+  }
+
+  // Local files and EKey opens without an ENCODING entry have no CKey.
+  // They would all share the zero key, and their hash check always passes.
+  if (!IsValidMD5(fileInfo.CKey)) {
+    return nullptr;
+  }
+
+  // Content the cache would reject is read the normal way, without a side
+  // block and hash check. Unknown sizes are CASC_INVALID_SIZE64 and go too.
+  if (!cache.Accepts(fileInfo.ContentSize)) {
+    return nullptr;
+  }
+
+  ContentBlockPtr block = cache.Find(fileInfo.CKey);
+  if (block) {
+    // Leave the file where a real read would have left it
+    CascSetFilePointer64(hFile, block->size, nullptr, FILE_BEGIN);
+    return block;
+  }
+
+  DWORD fileSize = CascGetFileSize(hFile, nullptr);
+  if (fileSize == CASC_INVALID_SIZE || fileSize == 0) {
+    return nullptr;
+  }
+
+  uint8_t* data = static_cast<uint8_t*>(malloc(fileSize));
+  if (data == nullptr) {
+    return nullptr;
+  }
+
+  DWORD bytesRead = 0;
+  if (!CascReadFileTimed(stats, hFile, data, fileSize, &bytesRead) || bytesRead != fileSize) {
+    free(data);
+    CascSetFilePointer64(hFile, 0, nullptr, FILE_BEGIN);
+    return nullptr;
+  }
+
+  block = std::make_shared<ContentBlock>(data, bytesRead);
+
+  // Never cache content that does not hash to its key (e.g. missing decryption keys)
+  if (CascVerifyDataBlockHash(data, bytesRead, fileInfo.CKey)) {
+    cache.Insert(fileInfo.CKey, block);
+  }
+
+  return block;
+}
+
+Napi::Buffer<uint8_t> ContentBlockBuffer(Napi::Env env, const ContentBlockPtr& block) {
+  // Cached content is never written after it is decoded, so every reader
+  // can share it
+  ContentBlockPtr* reference = new ContentBlockPtr(block);
+  return Napi::Buffer<uint8_t>::NewOrCopy(env, block->data, block->size,
+    [](Napi::Env /*env*/, uint8_t* /*data*/, ContentBlockPtr* reference) { delete reference; }, reference);
+}
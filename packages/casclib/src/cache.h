@@ -0,0 +1,91 @@
+#ifndef CASCLIB_CACHE_H
+#define CASCLIB_CACHE_H
+
+#include <napi.h>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "CascLib.h"
+#include "stats.h"
+
+// A block of decoded file content. The memory is freed when the last
+// reference (cache entry or a read in flight) goes away.
+struct ContentBlock {
+  uint8_t* data;
+  size_t size;
+
+  ContentBlock(uint8_t* data, size_t size) : data(data), size(size) {}
+  ~ContentBlock() { free(data); }
+};
+
+typedef std::shared_ptr<ContentBlock> ContentBlockPtr;
+
+struct ContentCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t insertions;
+  uint64_t entries;
+  uint64_t bytes;
+  uint64_t limit;
+};
+
+// Process-wide LRU cache of decoded file content, keyed by CKey.
+// Content is shared by every name, file and storage with the same CKey.
+// Disabled while the byte limit is 0 (the default).
+class ContentCache {
+public:
+  static ContentCache& Instance();
+
+  bool IsEnabled();
+
+  // True if content of this size fits the budget; larger content is never inserted
+  bool Accepts(uint64_t size);
+  void SetLimit(uint64_t limit);
+  void Clear();
+  ContentCacheStats GetStats();
+
+  // Returns the cached block and marks it most recently used
+  ContentBlockPtr Find(const BYTE* ckey);
+
+  // Adds a block, evicting least recently used entries to stay in budget
+  void Insert(const BYTE* ckey, const ContentBlockPtr& block);
+
+private:
+  ContentCache();
+
+  struct Entry {
+    std::string key;
+    ContentBlockPtr block;
+  };
+
+  void EvictLocked(uint64_t limit);
+
+  std::mutex lock;
+  std::list<Entry> lru;
+  std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+  uint64_t limit;
+  uint64_t bytes;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t insertions;
+};
+
+// Reads a whole file through the content cache. Safe to call from any thread.
+// Returns nullptr when the cache is disabled, the file position is not at
+// the start or the read fails; the caller then reads the file itself.
+// Content whose MD5 does not match the CKey is returned but not cached;
+// files without a valid CKey, or larger than the whole budget, bypass the
+// cache entirely.
+ContentBlockPtr CascReadFileCached(HANDLE hFile, CascStats* stats);
+
+// Wraps a block in a Buffer without copying it. The Buffer holds a
+// reference to the block, so the memory outlives eviction and clearing.
+Napi::Buffer<uint8_t> ContentBlockBuffer(Napi::Env env, const ContentBlockPtr& block);
+
+#endif // CASCLIB_CACHE_H
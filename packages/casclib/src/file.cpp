@@ -1,14 +1,196 @@
 #include "file.h"
-#include <vector>
+#include "cache.h"
+#include <algorithm>
+#include <cstdlib>
 
 Napi::FunctionReference CascFile::constructor;
 
+// Runs CascReadFile on the libuv thread pool and settles a Promise.
+// Holds a reference to the JS object so the handle outlives the operation.
+class CascReadWorker : public Napi::AsyncWorker {
+public:
+  CascReadWorker(Napi::Env env, CascFile* file, bool readAll, DWORD bytesToRead)
+    : Napi::AsyncWorker(env, "CascReadFile"),
+      deferred(Napi::Promise::Deferred::New(env)),
+      fileRef(Napi::Persistent(file->Value())),
+      file(file), hFile(file->hFile), readAll(readAll),
+      bytesToRead(bytesToRead), bytesRead(0), data(nullptr) {
+    file->isBusy = true;
+  }
+
+  Napi::Promise GetPromise() {
+    return deferred.Promise();
+  }
+
+protected:
+  void Execute() override {
+    if (readAll) {
+      cached = CascReadFileCached(hFile, file->stats.get());
+      if (cached) {
+        return;
+      }
+
+      ULONGLONG fileSize = 0;
+      if (!CascGetFileSize64(hFile, &fileSize)) {
+        SetError("Failed to get file size");
+        return;
+      }
+      if (fileSize > 0xFFFFFFFF) {
+        SetError("File is too large to read at once");
+        return;
+      }
+      bytesToRead = (DWORD)fileSize;
+    }
+
+    if (bytesToRead == 0) {
+      return;
+    }
+
+    data = static_cast<uint8_t*>(malloc(bytesToRead));
+    if (data == nullptr) {
+      SetError("Failed to allocate read buffer");
+      return;
+    }
+
+    if (!CascReadFileTimed(file->stats.get(), hFile, data, bytesToRead, &bytesRead)) {
+      SetError("Failed to read file");
+    }
+  }
+
+  void OnOK() override {
+    file->isBusy = false;
+
+    if (cached) {
+      deferred.Resolve(ContentBlockBuffer(Env(), cached));
+      return;
+    }
+
+    if (data == nullptr) {
+      deferred.Resolve(Napi::Buffer<uint8_t>::New(Env(), 0));
+      return;
+    }
+
+    // Hand the decoded memory to JS without copying it
+    uint8_t* result = data;
+    data = nullptr;
+    deferred.Resolve(Napi::Buffer<uint8_t>::NewOrCopy(Env(), result, bytesRead,
+      [](Napi::Env /*env*/, uint8_t* finalizeData) { free(finalizeData); }));
+  }
+
+  void OnError(const Napi::Error& e) override {
+    file->isBusy = false;
+    deferred.Reject(e.Value());
+  }
+
+  ~CascReadWorker() {
+    free(data);
+  }
+
+private:
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference fileRef;
+  CascFile* file;
+  HANDLE hFile;
+  bool readAll;
+  DWORD bytesToRead;
+  DWORD bytesRead;
+  uint8_t* data;
+  ContentBlockPtr cached;
+};
+
+// Runs a positional read on the libuv thread pool using a private handle,
+// so any number of these may run at once on the same file
+class CascReadAtWorker : public Napi::AsyncWorker {
+public:
+  CascReadAtWorker(Napi::Env env, std::shared_ptr<CascFileHandlePool> pool, ULONGLONG offset, DWORD length)
+    : Napi::AsyncWorker(env, "CascReadFileAt"),
+      deferred(Napi::Promise::Deferred::New(env)),
+      pool(std::move(pool)), offset(offset), length(length), bytesRead(0), data(nullptr) {
+  }
+
+  Napi::Promise GetPromise() {
+    return deferred.Promise();
+  }
+
+protected:
+  void Execute() override {
+    if (length == 0) {
+      return;
+    }
+
+    data = static_cast<uint8_t*>(malloc(length));
+    if (data == nullptr) {
+      SetError("Failed to allocate read buffer");
+      return;
+    }
+
+    if (!pool->ReadAt(offset, data, length, &bytesRead)) {
+      SetError("Failed to read file");
+    }
+  }
+
+  void OnOK() override {
+    if (data == nullptr || bytesRead == 0) {
+      deferred.Resolve(Napi::Buffer<uint8_t>::New(Env(), 0));
+      return;
+    }
+
+    uint8_t* result = data;
+    data = nullptr;
+    deferred.Resolve(Napi::Buffer<uint8_t>::NewOrCopy(Env(), result, bytesRead,
+      [](Napi::Env /*env*/, uint8_t* finalizeData) { free(finalizeData); }));
+  }
+
+  void OnError(const Napi::Error& e) override {
+    deferred.Reject(e.Value());
+  }
+
+  ~CascReadAtWorker() {
+    free(data);
+  }
+
+private:
+  Napi::Promise::Deferred deferred;
+  std::shared_ptr<CascFileHandlePool> pool;
+  ULONGLONG offset;
+  DWORD length;
+  DWORD bytesRead;
+  uint8_t* data;
+};
+
+// Resolves a Buffer, TypedArray or ArrayBuffer to its backing memory
+static bool GetWritableBytes(const Napi::Value& value, uint8_t** data, size_t* length) {
+  if (value.IsTypedArray()) {
+    Napi::TypedArray array = value.As<Napi::TypedArray>();
+    *data = static_cast<uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+    *length = array.ByteLength();
+    return true;
+  }
+
+  if (value.IsArrayBuffer()) {
+    Napi::ArrayBuffer array = value.As<Napi::ArrayBuffer>();
+    *data = static_cast<uint8_t*>(array.Data());
+    *length = array.ByteLength();
+    return true;
+  }
+
+  return false;
+}
+
 Napi::Object CascFile::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
 
   Napi::Function func = DefineClass(env, "File", {
     InstanceMethod("CascReadFile", &CascFile::Read),
     InstanceMethod("readFileAll", &CascFile::ReadAll),
+    InstanceMethod("readFileInto", &CascFile::ReadInto),
+    InstanceMethod("readFileAsync", &CascFile::ReadAsync),
+    InstanceMethod("readFileAllAsync", &CascFile::ReadAllAsync),
+    InstanceMethod("readFileAt", &CascFile::ReadAt),
+    InstanceMethod("readFileAtAsync", &CascFile::ReadAtAsync),
+    InstanceMethod("getFileFrames", &CascFile::GetFrames),
+    InstanceMethod("readFileFrames", &CascFile::ReadFrames),
+    InstanceMethod("readFileFramesAsync", &CascFile::ReadFramesAsync),
     InstanceMethod("CascGetFileSize", &CascFile::GetSize),
     InstanceMethod("CascGetFileSize64", &CascFile::GetSize64),
     InstanceMethod("CascGetFilePointer", &CascFile::GetPosition),
@@ -27,22 +209,23 @@ Napi::Object CascFile::Init(Napi::Env env, Napi::Object exports) {
   return exports;
 }
 
-Napi::Object CascFile::NewInstance(Napi::Env env, HANDLE hFile) {
+Napi::Object CascFile::NewInstance(Napi::Env env, HANDLE hFile, std::shared_ptr<CascStats> stats) {
   Napi::EscapableHandleScope scope(env);
   Napi::Object obj = constructor.New({});
   CascFile* file = Napi::ObjectWrap<CascFile>::Unwrap(obj);
   file->hFile = hFile;
   file->isOpen = true;
+  file->stats = std::move(stats);
   return scope.Escape(napi_value(obj)).ToObject();
 }
 
 CascFile::CascFile(const Napi::CallbackInfo& info) 
-  : Napi::ObjectWrap<CascFile>(info), hFile(nullptr), isOpen(false) {
+  : Napi::ObjectWrap<CascFile>(info), hFile(nullptr), isOpen(false), isBusy(false), framesLoaded(false) {
 }
 
 CascFile::~CascFile() {
   if (isOpen && hFile) {
-    CascCloseFile(hFile);
+    CascCloseFileCounted(stats.get(), hFile);
     hFile = nullptr;
     isOpen = false;
   }
@@ -57,21 +240,32 @@ Napi::Value CascFile::Read(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   DWORD bytesToRead = 4096; // Default buffer size
   if (info.Length() > 0 && info[0].IsNumber()) {
     bytesToRead = info[0].As<Napi::Number>().Uint32Value();
   }
 
-  std::vector<uint8_t> buffer(bytesToRead);
+  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, bytesToRead);
   DWORD bytesRead = 0;
 
-  if (!CascReadFile(hFile, buffer.data(), bytesToRead, &bytesRead)) {
+  if (!CascReadFileTimed(stats.get(), hFile, buffer.Data(), bytesToRead, &bytesRead)) {
     Napi::Error::New(env, "Failed to read file")
       .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Buffer<uint8_t>::Copy(env, buffer.data(), bytesRead);
+  // Only a short read (end of file) needs a smaller copy
+  if (bytesRead < bytesToRead) {
+    return Napi::Buffer<uint8_t>::Copy(env, buffer.Data(), bytesRead);
+  }
+
+  return buffer;
 }
 
 Napi::Value CascFile::ReadAll(const Napi::CallbackInfo& info) {
@@ -83,22 +277,412 @@ Napi::Value CascFile::ReadAll(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  DWORD fileSize = CascGetFileSize(hFile, nullptr);
-  
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Served from the content cache when it is enabled and the file is at the start
+  ContentBlockPtr cached = CascReadFileCached(hFile, stats.get());
+  if (cached) {
+    return ContentBlockBuffer(env, cached);
+  }
+
+  ULONGLONG fileSize64 = 0;
+  if (!CascGetFileSize64(hFile, &fileSize64)) {
+    Napi::Error::New(env, "Failed to get file size")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (fileSize64 > 0xFFFFFFFF) {
+    Napi::RangeError::New(env, "File is too large to read at once")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD fileSize = (DWORD)fileSize64;
   if (fileSize == 0) {
     return Napi::Buffer<uint8_t>::New(env, 0);
   }
 
-  std::vector<uint8_t> buffer(fileSize);
+  // Decode straight into the memory backing the returned Buffer
+  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, fileSize);
+  DWORD bytesRead = 0;
+
+  if (!CascReadFileTimed(stats.get(), hFile, buffer.Data(), fileSize, &bytesRead)) {
+    Napi::Error::New(env, "Failed to read file")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Only a short read (position not at the start) needs a smaller copy
+  if (bytesRead < fileSize) {
+    return Napi::Buffer<uint8_t>::Copy(env, buffer.Data(), bytesRead);
+  }
+
+  return buffer;
+}
+
+Napi::Value CascFile::ReadInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+
+  if (info.Length() < 1 || !GetWritableBytes(info[0], &data, &capacity)) {
+    Napi::TypeError::New(env, "Expected Buffer, TypedArray or ArrayBuffer as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t offset = 0;
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    offset = (size_t)info[1].As<Napi::Number>().Int64Value();
+  }
+
+  if (offset > capacity) {
+    Napi::RangeError::New(env, "Offset is outside of the target buffer")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t length = capacity - offset;
+  if (info.Length() > 2 && info[2].IsNumber()) {
+    size_t requested = (size_t)info[2].As<Napi::Number>().Int64Value();
+    if (requested > length) {
+      Napi::RangeError::New(env, "Length exceeds the target buffer")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    length = requested;
+  }
+
+  DWORD bytesToRead = (DWORD)std::min<size_t>(length, 0xFFFFFFFF);
+  DWORD bytesRead = 0;
+
+  if (bytesToRead > 0 && !CascReadFileTimed(stats.get(), hFile, data + offset, bytesToRead, &bytesRead)) {
+    Napi::Error::New(env, "Failed to read file")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Number::New(env, bytesRead);
+}
+
+Napi::Value CascFile::ReadAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD bytesToRead = 4096; // Default buffer size
+  if (info.Length() > 0 && info[0].IsNumber()) {
+    bytesToRead = info[0].As<Napi::Number>().Uint32Value();
+  }
+
+  CascReadWorker* worker = new CascReadWorker(env, this, false, bytesToRead);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascFile::ReadAllAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  CascReadWorker* worker = new CascReadWorker(env, this, true, 0);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+std::shared_ptr<CascFileHandlePool> CascFile::GetRangeArgs(const Napi::CallbackInfo& info,
+                                                        ULONGLONG* offset, DWORD* length) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Expected offset and length as arguments")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  double offsetValue = info[0].As<Napi::Number>().DoubleValue();
+  double lengthValue = info[1].As<Napi::Number>().DoubleValue();
+
+  if (!(offsetValue >= 0 && offsetValue <= 9007199254740991.0) || offsetValue != (double)(ULONGLONG)offsetValue) {
+    Napi::RangeError::New(env, "Offset must be a non-negative integer")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  if (!(lengthValue >= 0 && lengthValue <= 4294967295.0) || lengthValue != (double)(DWORD)lengthValue) {
+    Napi::RangeError::New(env, "Length must be an integer between 0 and 4294967295")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  std::shared_ptr<CascFileHandlePool> pool = GetHandlePool(env);
+  if (!pool) {
+    return nullptr;
+  }
+
+  *offset = (ULONGLONG)offsetValue;
+  *length = (DWORD)lengthValue;
+  return pool;
+}
+
+std::shared_ptr<CascFileHandlePool> CascFile::GetHandlePool(Napi::Env env) {
+  if (!handlePool) {
+    // Creating the pool queries the original handle, which a pending
+    // read may be loading frame tables into on a worker thread
+    if (isBusy) {
+      Napi::Error::New(env, "File has a pending asynchronous operation")
+        .ThrowAsJavaScriptException();
+      return nullptr;
+    }
+
+    std::shared_ptr<CascFileHandlePool> pool = std::make_shared<CascFileHandlePool>();
+    if (!pool->Init(hFile, stats)) {
+      Napi::Error::New(env, "Positional reads need a file opened from a storage")
+        .ThrowAsJavaScriptException();
+      return nullptr;
+    }
+    handlePool = pool;
+  }
+
+  return handlePool;
+}
+
+std::shared_ptr<CascFileHandlePool> CascFile::GetFrameArgs(const Napi::CallbackInfo& info,
+                                                        ULONGLONG* offset, DWORD* length) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "Expected first frame and frame count as arguments")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  std::shared_ptr<CascFileHandlePool> pool = GetHandlePool(env);
+  if (!pool) {
+    return nullptr;
+  }
+
+  if (!framesLoaded) {
+    if (!pool->GetFrames(frames, false)) {
+      Napi::Error::New(env, "Failed to load file frames")
+        .ThrowAsJavaScriptException();
+      return nullptr;
+    }
+    framesLoaded = true;
+  }
+
+  double firstValue = info[0].As<Napi::Number>().DoubleValue();
+  double countValue = info[1].As<Napi::Number>().DoubleValue();
+  double frameCount = (double)frames.size();
+
+  if (!(firstValue >= 0 && firstValue < frameCount) || firstValue != (double)(size_t)firstValue) {
+    Napi::RangeError::New(env, "First frame is out of range")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  if (!(countValue >= 1 && countValue <= frameCount - firstValue) || countValue != (double)(size_t)countValue) {
+    Napi::RangeError::New(env, "Frame count is out of range")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  const CascFrameInfo& firstFrame = frames[(size_t)firstValue];
+  const CascFrameInfo& lastFrame = frames[(size_t)firstValue + (size_t)countValue - 1];
+  ULONGLONG endOffset = lastFrame.contentOffset + lastFrame.contentSize;
+
+  if (endOffset - firstFrame.contentOffset > 0xFFFFFFFF) {
+    Napi::RangeError::New(env, "Frames are too large to read at once")
+      .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  *offset = firstFrame.contentOffset;
+  *length = (DWORD)(endOffset - firstFrame.contentOffset);
+  return pool;
+}
+
+// Reads a content range through the handle pool on the JS thread
+static Napi::Value ReadRange(Napi::Env env, CascFileHandlePool* pool, ULONGLONG offset, DWORD length) {
+  if (length == 0) {
+    return Napi::Buffer<uint8_t>::New(env, 0);
+  }
+
+  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, length);
   DWORD bytesRead = 0;
 
-  if (!CascReadFile(hFile, buffer.data(), fileSize, &bytesRead)) {
+  if (!pool->ReadAt(offset, buffer.Data(), length, &bytesRead)) {
     Napi::Error::New(env, "Failed to read file")
       .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Buffer<uint8_t>::Copy(env, buffer.data(), bytesRead);
+  // Ranges that run past the end of the file come back short
+  if (bytesRead < length) {
+    return Napi::Buffer<uint8_t>::Copy(env, buffer.Data(), bytesRead);
+  }
+
+  return buffer;
+}
+
+Napi::Value CascFile::ReadAt(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ULONGLONG offset = 0;
+  DWORD length = 0;
+
+  std::shared_ptr<CascFileHandlePool> pool = GetRangeArgs(info, &offset, &length);
+  if (!pool) {
+    return env.Null();
+  }
+
+  return ReadRange(env, pool.get(), offset, length);
+}
+
+Napi::Value CascFile::ReadAtAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ULONGLONG offset = 0;
+  DWORD length = 0;
+
+  std::shared_ptr<CascFileHandlePool> pool = GetRangeArgs(info, &offset, &length);
+  if (!pool) {
+    return env.Null();
+  }
+
+  CascReadAtWorker* worker = new CascReadAtWorker(env, pool, offset, length);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascFile::GetFrames(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<CascFileHandlePool> pool = GetHandlePool(env);
+  if (!pool) {
+    return env.Null();
+  }
+
+  // Reading the modes touches every frame, so this list is not cached
+  std::vector<CascFrameInfo> list;
+  if (!pool->GetFrames(list, true)) {
+    Napi::Error::New(env, "Failed to load file frames")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t count = list.size();
+  Napi::Uint32Array spanIndexes = Napi::Uint32Array::New(env, count);
+  Napi::Float64Array contentOffsets = Napi::Float64Array::New(env, count);
+  Napi::Uint32Array contentSizes = Napi::Uint32Array::New(env, count);
+  Napi::Float64Array encodedOffsets = Napi::Float64Array::New(env, count);
+  Napi::Uint32Array encodedSizes = Napi::Uint32Array::New(env, count);
+  Napi::Uint8Array modes = Napi::Uint8Array::New(env, count);
+
+  for (size_t i = 0; i < count; i++) {
+    spanIndexes[i] = list[i].spanIndex;
+    contentOffsets[i] = (double)list[i].contentOffset;
+    contentSizes[i] = list[i].contentSize;
+    encodedOffsets[i] = (double)list[i].encodedOffset;
+    encodedSizes[i] = list[i].encodedSize;
+    modes[i] = list[i].mode;
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("count", Napi::Number::New(env, (double)count));
+  result.Set("spanIndexes", spanIndexes);
+  result.Set("contentOffsets", contentOffsets);
+  result.Set("contentSizes", contentSizes);
+  result.Set("encodedOffsets", encodedOffsets);
+  result.Set("encodedSizes", encodedSizes);
+  result.Set("modes", modes);
+  return result;
+}
+
+Napi::Value CascFile::ReadFrames(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ULONGLONG offset = 0;
+  DWORD length = 0;
+
+  std::shared_ptr<CascFileHandlePool> pool = GetFrameArgs(info, &offset, &length);
+  if (!pool) {
+    return env.Null();
+  }
+
+  return ReadRange(env, pool.get(), offset, length);
+}
+
+Napi::Value CascFile::ReadFramesAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ULONGLONG offset = 0;
+  DWORD length = 0;
+
+  std::shared_ptr<CascFileHandlePool> pool = GetFrameArgs(info, &offset, &length);
+  if (!pool) {
+    return env.Null();
+  }
+
+  CascReadAtWorker* worker = new CascReadAtWorker(env, pool, offset, length);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
 }
 
 Napi::Value CascFile::GetSize(const Napi::CallbackInfo& info) {
@@ -110,6 +694,12 @@ Napi::Value CascFile::GetSize(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   DWORD fileSize = CascGetFileSize(hFile, nullptr);
   return Napi::Number::New(env, fileSize);
 }
@@ -123,6 +713,12 @@ Napi::Value CascFile::GetPosition(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   LONG distanceToMove = 0;
   DWORD position = CascSetFilePointer(hFile, distanceToMove, nullptr, FILE_CURRENT);
   
@@ -138,6 +734,12 @@ Napi::Value CascFile::SetPosition(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env, "Expected position as first argument")
       .ThrowAsJavaScriptException();
@@ -157,12 +759,23 @@ Napi::Value CascFile::Close(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, false);
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (hFile) {
-    CascCloseFile(hFile);
+    CascCloseFileCounted(stats.get(), hFile);
     hFile = nullptr;
     isOpen = false;
   }
 
+  // Positional reads still in flight keep their own reference
+  handlePool.reset();
+  frames.clear();
+  framesLoaded = false;
+
   return Napi::Boolean::New(env, true);
 }
 
@@ -175,6 +788,12 @@ Napi::Value CascFile::GetSize64(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   ULONGLONG fileSize = 0;
   if (!CascGetFileSize64(hFile, &fileSize)) {
     Napi::Error::New(env, "Failed to get file size")
@@ -194,6 +813,12 @@ Napi::Value CascFile::GetPosition64(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   ULONGLONG position = 0;
   if (!CascSetFilePointer64(hFile, 0, &position, FILE_CURRENT)) {
     Napi::Error::New(env, "Failed to get file position")
@@ -213,6 +838,12 @@ Napi::Value CascFile::SetPosition64(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env, "Expected position as first argument")
       .ThrowAsJavaScriptException();
@@ -245,6 +876,12 @@ Napi::Value CascFile::GetFileInfo(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env, "Expected info class as first argument")
       .ThrowAsJavaScriptException();
@@ -292,6 +929,31 @@ Napi::Value CascFile::GetFileInfo(const Napi::CallbackInfo& info) {
       }
       break;
     }
+    case CascFileSpanInfo: {
+      size_t bytesNeeded = 0;
+      CascGetFileInfo(hFile, infoClass, nullptr, 0, &bytesNeeded);
+
+      std::vector<CASC_FILE_SPAN_INFO> spans(bytesNeeded / sizeof(CASC_FILE_SPAN_INFO));
+      Napi::Array spanArray = Napi::Array::New(env);
+
+      if (!spans.empty() && CascGetFileInfo(hFile, infoClass, spans.data(),
+                                            spans.size() * sizeof(CASC_FILE_SPAN_INFO), &bytesNeeded)) {
+        for (size_t i = 0; i < spans.size(); i++) {
+          Napi::Object span = Napi::Object::New(env);
+          span.Set("ckey", Napi::Buffer<BYTE>::Copy(env, spans[i].CKey, MD5_HASH_SIZE));
+          span.Set("ekey", Napi::Buffer<BYTE>::Copy(env, spans[i].EKey, MD5_HASH_SIZE));
+          span.Set("startOffset", Napi::Number::New(env, (double)spans[i].StartOffset));
+          span.Set("endOffset", Napi::Number::New(env, (double)spans[i].EndOffset));
+          span.Set("archiveIndex", Napi::Number::New(env, spans[i].ArchiveIndex));
+          span.Set("archiveOffs", Napi::Number::New(env, spans[i].ArchiveOffs));
+          span.Set("headerSize", Napi::Number::New(env, spans[i].HeaderSize));
+          span.Set("frameCount", Napi::Number::New(env, spans[i].FrameCount));
+          spanArray.Set((uint32_t)i, span);
+        }
+      }
+      result.Set("spans", spanArray);
+      break;
+    }
     default:
       Napi::Error::New(env, "Unsupported info class")
         .ThrowAsJavaScriptException();
@@ -310,6 +972,12 @@ Napi::Value CascFile::SetFileFlags(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (isBusy) {
+    Napi::Error::New(env, "File has a pending asynchronous operation")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (info.Length() < 1 || !info[0].IsNumber()) {
     Napi::TypeError::New(env, "Expected flags as first argument")
       .ThrowAsJavaScriptException();
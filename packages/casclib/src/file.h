@@ -2,12 +2,15 @@
 #define CASCLIB_FILE_H
 
 #include <napi.h>
+#include <memory>
 #include "CascLib.h"
+#include "filepool.h"
+#include "stats.h"
 
 class CascFile : public Napi::ObjectWrap<CascFile> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
-  static Napi::Object NewInstance(Napi::Env env, HANDLE hFile);
+  static Napi::Object NewInstance(Napi::Env env, HANDLE hFile, std::shared_ptr<CascStats> stats = nullptr);
   CascFile(const Napi::CallbackInfo& info);
   ~CascFile();
 
@@ -17,6 +20,14 @@ private:
   // Methods
   Napi::Value Read(const Napi::CallbackInfo& info);
   Napi::Value ReadAll(const Napi::CallbackInfo& info);
+  Napi::Value ReadInto(const Napi::CallbackInfo& info);
+  Napi::Value ReadAsync(const Napi::CallbackInfo& info);
+  Napi::Value ReadAllAsync(const Napi::CallbackInfo& info);
+  Napi::Value ReadAt(const Napi::CallbackInfo& info);
+  Napi::Value ReadAtAsync(const Napi::CallbackInfo& info);
+  Napi::Value GetFrames(const Napi::CallbackInfo& info);
+  Napi::Value ReadFrames(const Napi::CallbackInfo& info);
+  Napi::Value ReadFramesAsync(const Napi::CallbackInfo& info);
   Napi::Value GetSize(const Napi::CallbackInfo& info);
   Napi::Value GetSize64(const Napi::CallbackInfo& info);
   Napi::Value GetPosition(const Napi::CallbackInfo& info);
@@ -27,9 +38,32 @@ private:
   Napi::Value SetFileFlags(const Napi::CallbackInfo& info);
   Napi::Value Close(const Napi::CallbackInfo& info);
 
+  // Parses (offset, length) and returns the handle pool, or throws
+  std::shared_ptr<CascFileHandlePool> GetRangeArgs(const Napi::CallbackInfo& info, ULONGLONG* offset, DWORD* length);
+
+  // Parses (first, count) and converts the frames to a content range, or throws
+  std::shared_ptr<CascFileHandlePool> GetFrameArgs(const Napi::CallbackInfo& info, ULONGLONG* offset, DWORD* length);
+
+  // Creates the handle pool on first use, or throws
+  std::shared_ptr<CascFileHandlePool> GetHandlePool(Napi::Env env);
+
+  // Async workers complete on the JS thread and clear isBusy
+  friend class CascReadWorker;
+
   // Member variables
   HANDLE hFile;
   bool isOpen;
+  bool isBusy;
+
+  // Counters of the storage the file was opened from, if any
+  std::shared_ptr<CascStats> stats;
+
+  // Created on the first positional read
+  std::shared_ptr<CascFileHandlePool> handlePool;
+
+  // Frame table, loaded by the first readFrames call
+  std::vector<CascFrameInfo> frames;
+  bool framesLoaded;
 };
 
 #endif // CASCLIB_FILE_H
@@ -0,0 +1,178 @@
+#include "filepool.h"
+#include "CascCommon.h"
+#include <cstring>
+#include <map>
+
+// Idle handles kept per file; more are opened on demand and closed after use
+static const size_t kMaxIdleHandles = 8;
+
+CascFileHandlePool::CascFileHandlePool() : hPinned(nullptr), hStorage(nullptr) {
+  memset(ekey, 0, sizeof(ekey));
+}
+
+CascFileHandlePool::~CascFileHandlePool() {
+  for (HANDLE hFile : idle) {
+    CascCloseFile(hFile);
+  }
+  if (hPinned != nullptr) {
+    CascCloseFile(hPinned);
+  }
+}
+
+bool CascFileHandlePool::Init(HANDLE hFile, std::shared_ptr<CascStats> stats) {
+  TCascFile* hf = TCascFile::IsValid(hFile);
+  CASC_FILE_FULL_INFO fileInfo = {0};
+
+  if (hf == nullptr || hf->hs == nullptr) {
+    SetCascError(ERROR_NOT_SUPPORTED);
+    return false;
+  }
+
+  if (!CascGetFileInfo(hFile, CascFileFullInfo, &fileInfo, sizeof(fileInfo), nullptr)) {
+    return false;
+  }
+
+  // Opened here, while the caller still holds the storage open. Handles
+  // opened later on worker threads rely on this one keeping it alive.
+  if (!CascOpenFile(hf->hs, fileInfo.EKey, CASC_LOCALE_ALL, CASC_OPEN_BY_EKEY, &hPinned)) {
+    hPinned = nullptr;
+    return false;
+  }
+
+  hStorage = hf->hs;
+  memcpy(ekey, fileInfo.EKey, MD5_HASH_SIZE);
+  this->stats = std::move(stats);
+  return true;
+}
+
+HANDLE CascFileHandlePool::Acquire() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!idle.empty()) {
+      HANDLE hFile = idle.back();
+      idle.pop_back();
+      return hFile;
+    }
+  }
+
+  // The EKey names exactly this content, whatever the file was opened by
+  HANDLE hFile = nullptr;
+  if (!CascOpenFile(hStorage, ekey, CASC_LOCALE_ALL, CASC_OPEN_BY_EKEY, &hFile)) {
+    return nullptr;
+  }
+  return hFile;
+}
+
+void CascFileHandlePool::Release(HANDLE hFile) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (idle.size() < kMaxIdleHandles) {
+      idle.push_back(hFile);
+      return;
+    }
+  }
+
+  CascCloseFile(hFile);
+}
+
+bool CascFileHandlePool::ReadAt(ULONGLONG offset, void* buffer, DWORD length, DWORD* bytesRead) {
+  HANDLE hFile = Acquire();
+  *bytesRead = 0;
+
+  if (hFile == nullptr) {
+    return false;
+  }
+
+  ULONGLONG fileSize = 0;
+  bool result = CascGetFileSize64(hFile, &fileSize);
+
+  // CascReadFile only decodes the frames that overlap the requested range.
+  // Reads that start at or past the end return no data.
+  if (result && offset < fileSize && length > 0) {
+    result = CascSetFilePointer64(hFile, (LONGLONG)offset, nullptr, FILE_BEGIN) &&
+             CascReadFileTimed(stats.get(), hFile, buffer, length, bytesRead);
+  }
+
+  Release(hFile);
+  return result;
+}
+
+bool CascFileHandlePool::GetFrames(std::vector<CascFrameInfo>& frames, bool readModes) {
+  HANDLE hFile = Acquire();
+  BYTE firstByte = 0;
+  DWORD bytesRead = 0;
+
+  if (hFile == nullptr) {
+    return false;
+  }
+
+  TCascFile* hf = TCascFile::IsValid(hFile);
+  if (hf == nullptr) {
+    Release(hFile);
+    return false;
+  }
+
+  // CascLib loads a span's frame table on the first read inside that span.
+  // One byte at the start of every span without a table loads them all;
+  // a span that still has none fails the call rather than dropping frames.
+  for (DWORD spanIndex = 0; spanIndex < hf->SpanCount; spanIndex++) {
+    PCASC_FILE_SPAN pFileSpan = &hf->pFileSpan[spanIndex];
+    if (pFileSpan->pFrames != nullptr || pFileSpan->EndOffset <= pFileSpan->StartOffset) {
+      continue;
+    }
+    if (!CascSetFilePointer64(hFile, (LONGLONG)pFileSpan->StartOffset, nullptr, FILE_BEGIN) ||
+        !CascReadFile(hFile, &firstByte, 1, &bytesRead) || pFileSpan->pFrames == nullptr) {
+      Release(hFile);
+      return false;
+    }
+  }
+
+  std::map<TFileStream*, TFileStream*> streams;
+  frames.clear();
+
+  for (DWORD spanIndex = 0; spanIndex < hf->SpanCount; spanIndex++) {
+    PCASC_FILE_SPAN pFileSpan = &hf->pFileSpan[spanIndex];
+    TFileStream* pStream = nullptr;
+
+    // The data file stream is shared by every reader of the storage, so
+    // the modes are read through a private read-only stream of the same file
+    if (readModes && pFileSpan->pStream != nullptr) {
+      auto it = streams.find(pFileSpan->pStream);
+      if (it == streams.end()) {
+        LPCTSTR szFileName = FileStream_GetFileName(pFileSpan->pStream);
+        TFileStream* pPrivate = szFileName ? FileStream_OpenFile(szFileName, STREAM_FLAG_READ_ONLY) : nullptr;
+        it = streams.emplace(pFileSpan->pStream, pPrivate).first;
+      }
+      pStream = it->second;
+    }
+
+    for (DWORD i = 0; pFileSpan->pFrames != nullptr && i < pFileSpan->FrameCount; i++) {
+      PCASC_FILE_FRAME pFrame = &pFileSpan->pFrames[i];
+      CascFrameInfo frame;
+
+      frame.spanIndex = spanIndex;
+      frame.contentOffset = pFrame->StartOffset;
+      frame.contentSize = pFrame->ContentSize;
+      frame.encodedOffset = pFrame->DataFileOffset;
+      frame.encodedSize = pFrame->EncodedSize;
+      frame.mode = 0;
+
+      // The first byte of every encoded frame is its BLTE mode
+      ULONGLONG modeOffset = pFrame->DataFileOffset;
+      if (pStream != nullptr && pFrame->EncodedSize > 0) {
+        FileStream_Read(pStream, &modeOffset, &frame.mode, 1);
+      }
+
+      frames.push_back(frame);
+    }
+  }
+
+  for (auto& entry : streams) {
+    if (entry.second != nullptr) {
+      FileStream_Close(entry.second);
+    }
+  }
+
+  Release(hFile);
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef CASCLIB_FILEPOOL_H
+#define CASCLIB_FILEPOOL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CascLib.h"
+#include "stats.h"
+
+// One BLTE frame of a file. Offsets of the decoded content are relative to
+// the file; encoded offsets are absolute within the data file.
+struct CascFrameInfo {
+  DWORD spanIndex;
+  ULONGLONG contentOffset;
+  DWORD contentSize;
+  ULONGLONG encodedOffset;
+  DWORD encodedSize;
+  BYTE mode;  // 'N', 'Z', '4', 'F' or 'E'; 0 if the data file is not local
+};
+
+// Private handles to the content of one open file. Positional reads take a
+// handle of their own, so they never share a file pointer and may run on
+// several threads at once. Each clone holds a reference to the storage;
+// Init opens one that lives as long as the pool, so the storage stays
+// alive after the original handle and the storage handle are closed.
+class CascFileHandlePool {
+public:
+  CascFileHandlePool();
+  ~CascFileHandlePool();
+
+  // Captures the storage and EKey of hFile and opens the pinning clone;
+  // false if the file has no storage (e.g. opened with CascOpenLocalFile).
+  // Must run on the thread that owns hFile. Reads are counted in stats.
+  bool Init(HANDLE hFile, std::shared_ptr<CascStats> stats);
+
+  // Reads up to length bytes at offset without touching any file pointer
+  // visible to the caller. Safe to call from any thread.
+  bool ReadAt(ULONGLONG offset, void* buffer, DWORD length, DWORD* bytesRead);
+
+  // Lists the frames of every span, loading the frame table of each span
+  // that has not been read yet; false if any of them cannot be loaded.
+  // Reading the modes costs one small read per frame, done through a
+  // private stream so the data file stream CascLib reads from is not shared.
+  bool GetFrames(std::vector<CascFrameInfo>& frames, bool readModes);
+
+private:
+  HANDLE Acquire();
+  void Release(HANDLE hFile);
+
+  std::mutex lock;
+  std::vector<HANDLE> idle;
+  HANDLE hPinned;
+  HANDLE hStorage;
+  BYTE ekey[MD5_HASH_SIZE];
+  std::shared_ptr<CascStats> stats;
+};
+
+#endif // CASCLIB_FILEPOOL_H
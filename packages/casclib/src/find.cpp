@@ -0,0 +1,257 @@
+#include "find.h"
+#include <cstring>
+
+// Copies a column into a freshly allocated typed array
+template <typename T>
+static Napi::TypedArrayOf<T> ToTypedArray(Napi::Env env, const std::vector<T>& values) {
+  Napi::TypedArrayOf<T> array = Napi::TypedArrayOf<T>::New(env, values.size());
+  if (!values.empty()) {
+    memcpy(array.Data(), values.data(), values.size() * sizeof(T));
+  }
+  return array;
+}
+
+CascFindBatch::CascFindBatch() {
+  nameOffsets.push_back(0);
+}
+
+size_t CascFindBatch::Count() const {
+  return fileSizes.size();
+}
+
+void CascFindBatch::Reserve(size_t entries) {
+  ckeys.reserve(entries * MD5_HASH_SIZE);
+  ekeys.reserve(entries * MD5_HASH_SIZE);
+  fileSizes.reserve(entries);
+  tagBitMasks.reserve(entries);
+  fileDataIds.reserve(entries);
+  localeFlags.reserve(entries);
+  contentFlags.reserve(entries);
+  spanCounts.reserve(entries);
+  available.reserve(entries);
+  nameTypes.reserve(entries);
+  nameOffsets.reserve(entries + 1);
+}
+
+void CascFindBatch::Append(const CASC_FIND_DATA& findData) {
+  ckeys.insert(ckeys.end(), findData.CKey, findData.CKey + MD5_HASH_SIZE);
+  ekeys.insert(ekeys.end(), findData.EKey, findData.EKey + MD5_HASH_SIZE);
+  fileSizes.push_back((double)findData.FileSize);
+  tagBitMasks.push_back((double)findData.TagBitMask);
+  fileDataIds.push_back(findData.dwFileDataId);
+  localeFlags.push_back(findData.dwLocaleFlags);
+  contentFlags.push_back(findData.dwContentFlags);
+  spanCounts.push_back(findData.dwSpanCount);
+  available.push_back(findData.bFileAvailable ? 1 : 0);
+  nameTypes.push_back((uint8_t)findData.NameType);
+  names.append(findData.szFileName);
+  nameOffsets.push_back((uint32_t)names.size());
+}
+
+Napi::Object CascFindBatch::ToObject(Napi::Env env) const {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("count", Napi::Number::New(env, (double)Count()));
+  result.Set("ckeys", Napi::Buffer<BYTE>::Copy(env, ckeys.data(), ckeys.size()));
+  result.Set("ekeys", Napi::Buffer<BYTE>::Copy(env, ekeys.data(), ekeys.size()));
+  result.Set("fileSizes", ToTypedArray(env, fileSizes));
+  result.Set("tagBitMasks", ToTypedArray(env, tagBitMasks));
+  result.Set("fileDataIds", ToTypedArray(env, fileDataIds));
+  result.Set("localeFlags", ToTypedArray(env, localeFlags));
+  result.Set("contentFlags", ToTypedArray(env, contentFlags));
+  result.Set("spanCounts", ToTypedArray(env, spanCounts));
+  result.Set("available", ToTypedArray(env, available));
+  result.Set("nameTypes", ToTypedArray(env, nameTypes));
+  result.Set("names", Napi::Buffer<char>::Copy(env, names.data(), names.size()));
+  result.Set("nameOffsets", ToTypedArray(env, nameOffsets));
+  return result;
+}
+
+bool CascFindNextBatch(CascRootLock& rootLock, bool hasListFile, HANDLE hFind, size_t maxEntries, CascFindBatch& batch,
+                       CascStats* stats) {
+  CASC_FIND_DATA findData;
+
+  while (batch.Count() < maxEntries) {
+    if (!CascFindNextFileLocked(rootLock, hasListFile, stats, hFind, &findData)) {
+      return false;
+    }
+    batch.Append(findData);
+  }
+
+  return true;
+}
+
+// Fetches the next batch of an iterator on the libuv thread pool
+class CascFindBatchWorker : public Napi::AsyncWorker {
+public:
+  CascFindBatchWorker(Napi::Env env, CascFindIterator* iterator, std::unique_ptr<CascFindBatch> batch)
+    : Napi::AsyncWorker(env, "CascFindNextFile"),
+      iteratorRef(Napi::Persistent(iterator->Value())),
+      iterator(iterator), hFind(iterator->hFind), batchSize(iterator->batchSize), stats(iterator->stats.get()),
+      rootLock(iterator->rootLock.get()), hasListFile(iterator->hasListFile), batch(std::move(batch)), hasMore(false) {
+  }
+
+protected:
+  void Execute() override {
+    hasMore = CascFindNextBatch(*rootLock, hasListFile, hFind, batchSize, *batch, stats);
+  }
+
+  void OnOK() override {
+    iterator->OnBatchFetched(std::move(batch), hasMore);
+  }
+
+private:
+  Napi::ObjectReference iteratorRef;
+  CascFindIterator* iterator;
+  HANDLE hFind;
+  size_t batchSize;
+  CascStats* stats;
+  CascRootLock* rootLock;
+  bool hasListFile;
+  std::unique_ptr<CascFindBatch> batch;
+  bool hasMore;
+};
+
+Napi::FunctionReference CascFindIterator::constructor;
+
+Napi::Object CascFindIterator::Init(Napi::Env env, Napi::Object exports) {
+  Napi::HandleScope scope(env);
+
+  Napi::Function func = DefineClass(env, "FindIterator", {
+    InstanceMethod("nextBatch", &CascFindIterator::NextBatch),
+    InstanceMethod("CascFindClose", &CascFindIterator::Close)
+  });
+
+  constructor = Napi::Persistent(func);
+  constructor.SuppressDestruct();
+
+  exports.Set("FindIterator", func);
+  return exports;
+}
+
+Napi::Object CascFindIterator::NewInstance(Napi::Env env, HANDLE hFind, const CASC_FIND_DATA* firstData, size_t batchSize,
+                                           std::shared_ptr<CascStats> stats, std::shared_ptr<CascRootLock> rootLock,
+                                           bool hasListFile) {
+  Napi::EscapableHandleScope scope(env);
+  Napi::Object obj = constructor.New({});
+  CascFindIterator* iterator = Napi::ObjectWrap<CascFindIterator>::Unwrap(obj);
+  iterator->batchSize = batchSize;
+  iterator->stats = std::move(stats);
+  iterator->rootLock = std::move(rootLock);
+  iterator->hasListFile = hasListFile;
+
+  if (hFind && firstData) {
+    // Seed the first batch with the entry CascFindFirstFile already returned
+    std::unique_ptr<CascFindBatch> batch(new CascFindBatch());
+    batch->Reserve(batchSize);
+    batch->Append(*firstData);
+
+    iterator->hFind = hFind;
+    iterator->isExhausted = false;
+    iterator->StartFetch(std::move(batch));
+  }
+
+  return scope.Escape(napi_value(obj)).ToObject();
+}
+
+CascFindIterator::CascFindIterator(const Napi::CallbackInfo& info)
+  : Napi::ObjectWrap<CascFindIterator>(info), hFind(nullptr), batchSize(4096),
+    hasListFile(false), isFetching(false), isExhausted(true), isClosed(false) {
+}
+
+CascFindIterator::~CascFindIterator() {
+  CloseHandle();
+}
+
+void CascFindIterator::StartFetch(std::unique_ptr<CascFindBatch> batch) {
+  if (!batch) {
+    batch.reset(new CascFindBatch());
+    batch->Reserve(batchSize);
+  }
+
+  isFetching = true;
+  CascFindBatchWorker* worker = new CascFindBatchWorker(Env(), this, std::move(batch));
+  worker->Queue();
+}
+
+void CascFindIterator::OnBatchFetched(std::unique_ptr<CascFindBatch> batch, bool hasMore) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  isFetching = false;
+
+  if (!hasMore || isClosed) {
+    isExhausted = true;
+    CloseHandle();
+  }
+
+  if (isClosed || batch->Count() == 0) {
+    batch.reset();
+  }
+
+  if (waiter) {
+    std::unique_ptr<Napi::Promise::Deferred> deferred = std::move(waiter);
+    deferred->Resolve(batch ? batch->ToObject(env) : env.Null());
+
+    // Keep one batch in flight while JS works on this one
+    if (!isExhausted) {
+      StartFetch(nullptr);
+    }
+    return;
+  }
+
+  ready = std::move(batch);
+}
+
+void CascFindIterator::CloseHandle() {
+  if (hFind) {
+    CascFindClose(hFind);
+    hFind = nullptr;
+  }
+}
+
+Napi::Value CascFindIterator::NextBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+  if (waiter) {
+    deferred.Reject(Napi::Error::New(env, "A nextBatch call is already pending").Value());
+    return deferred.Promise();
+  }
+
+  if (ready) {
+    std::unique_ptr<CascFindBatch> batch = std::move(ready);
+    deferred.Resolve(batch->ToObject(env));
+
+    if (!isExhausted && !isFetching) {
+      StartFetch(nullptr);
+    }
+    return deferred.Promise();
+  }
+
+  if (isFetching) {
+    waiter.reset(new Napi::Promise::Deferred(deferred));
+    return deferred.Promise();
+  }
+
+  deferred.Resolve(env.Null());
+  return deferred.Promise();
+}
+
+Napi::Value CascFindIterator::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (isClosed) {
+    return Napi::Boolean::New(env, false);
+  }
+
+  isClosed = true;
+  isExhausted = true;
+  ready.reset();
+
+  // A fetch in flight still owns the handle; it is closed when the fetch completes
+  if (!isFetching) {
+    CloseHandle();
+  }
+
+  return Napi::Boolean::New(env, true);
+}
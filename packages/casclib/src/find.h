@@ -0,0 +1,79 @@
+#ifndef CASCLIB_FIND_H
+#define CASCLIB_FIND_H
+
+#include <napi.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CascLib.h"
+#include "lookup.h"
+#include "stats.h"
+
+// Columnar copy of a run of CASC_FIND_DATA entries.
+// Built on any thread; converted to typed arrays on the JS thread.
+struct CascFindBatch {
+  std::vector<BYTE> ckeys;            // MD5_HASH_SIZE bytes per entry
+  std::vector<BYTE> ekeys;            // MD5_HASH_SIZE bytes per entry
+  std::vector<double> fileSizes;
+  std::vector<double> tagBitMasks;
+  std::vector<uint32_t> fileDataIds;
+  std::vector<uint32_t> localeFlags;
+  std::vector<uint32_t> contentFlags;
+  std::vector<uint32_t> spanCounts;
+  std::vector<uint8_t> available;
+  std::vector<uint8_t> nameTypes;
+  std::string names;                  // UTF-8 names stored back to back
+  std::vector<uint32_t> nameOffsets;  // count + 1 offsets into names
+
+  CascFindBatch();
+
+  size_t Count() const;
+  void Reserve(size_t entries);
+  void Append(const CASC_FIND_DATA& findData);
+  Napi::Object ToObject(Napi::Env env) const;
+};
+
+// Appends entries from an active search until the batch holds maxEntries.
+// Returns false once the search has no more entries.
+bool CascFindNextBatch(CascRootLock& rootLock, bool hasListFile, HANDLE hFind, size_t maxEntries, CascFindBatch& batch,
+                       CascStats* stats);
+
+// Enumeration with its own CascFindFirstFile handle. The next batch is
+// fetched on a worker thread while JS consumes the current one, and any
+// number of iterators can run against the same storage.
+class CascFindIterator : public Napi::ObjectWrap<CascFindIterator> {
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  static Napi::Object NewInstance(Napi::Env env, HANDLE hFind, const CASC_FIND_DATA* firstData, size_t batchSize,
+                                  std::shared_ptr<CascStats> stats, std::shared_ptr<CascRootLock> rootLock,
+                                  bool hasListFile);
+  CascFindIterator(const Napi::CallbackInfo& info);
+  ~CascFindIterator();
+
+private:
+  static Napi::FunctionReference constructor;
+
+  // Methods
+  Napi::Value NextBatch(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+
+  void StartFetch(std::unique_ptr<CascFindBatch> batch);
+  void OnBatchFetched(std::unique_ptr<CascFindBatch> batch, bool hasMore);
+  void CloseHandle();
+
+  friend class CascFindBatchWorker;
+
+  // Member variables
+  HANDLE hFind;
+  size_t batchSize;
+  std::shared_ptr<CascStats> stats;
+  std::shared_ptr<CascRootLock> rootLock;
+  bool hasListFile;
+  bool isFetching;
+  bool isExhausted;
+  bool isClosed;
+  std::unique_ptr<CascFindBatch> ready;
+  std::unique_ptr<Napi::Promise::Deferred> waiter;
+};
+
+#endif // CASCLIB_FIND_H
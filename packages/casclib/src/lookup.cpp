@@ -0,0 +1,202 @@
+#include "lookup.h"
+#include "CascCommon.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+static void CopyCKeyEntry(PCASC_CKEY_ENTRY pCKeyEntry, CascFileStat& stat) {
+  memcpy(stat.CKey, pCKeyEntry->CKey, MD5_HASH_SIZE);
+  memcpy(stat.EKey, pCKeyEntry->EKey, MD5_HASH_SIZE);
+  stat.ContentSize = (pCKeyEntry->ContentSize != CASC_INVALID_SIZE) ? pCKeyEntry->ContentSize : CASC_INVALID_SIZE64;
+}
+
+// Fills the stat from an open file handle
+static bool StatFileHandle(HANDLE hFile, CascFileStat& stat) {
+  CASC_FILE_FULL_INFO fullInfo = {0};
+  ULONGLONG fileSize = 0;
+
+  if (!CascGetFileInfo(hFile, CascFileFullInfo, &fullInfo, sizeof(fullInfo), nullptr)) {
+    return false;
+  }
+
+  if (!CascGetFileSize64(hFile, &fileSize)) {
+    return false;
+  }
+
+  memcpy(stat.CKey, fullInfo.CKey, MD5_HASH_SIZE);
+  memcpy(stat.EKey, fullInfo.EKey, MD5_HASH_SIZE);
+  stat.ContentSize = fileSize;
+  return true;
+}
+
+size_t CascFileRefs::Count() const {
+  switch (openType) {
+    case CASC_OPEN_BY_CKEY:
+    case CASC_OPEN_BY_EKEY:
+      return keys.size() / MD5_HASH_SIZE;
+    case CASC_OPEN_BY_FILEID:
+      return fileDataIds.size();
+    default:
+      return names.size();
+  }
+}
+
+const void* CascFileRefs::Get(size_t index) const {
+  switch (openType) {
+    case CASC_OPEN_BY_CKEY:
+    case CASC_OPEN_BY_EKEY:
+      return &keys[index * MD5_HASH_SIZE];
+    case CASC_OPEN_BY_FILEID:
+      return CASC_FILE_DATA_ID(fileDataIds[index]);
+    default:
+      return names[index].c_str();
+  }
+}
+
+std::string CascFileRefs::Describe(size_t index) const {
+  switch (openType) {
+    case CASC_OPEN_BY_CKEY:
+    case CASC_OPEN_BY_EKEY:
+      return CascKeyToString(&keys[index * MD5_HASH_SIZE]);
+    case CASC_OPEN_BY_FILEID: {
+      char szFileName[32];
+      snprintf(szFileName, sizeof(szFileName), CASC_FILEID_FORMAT, fileDataIds[index]);
+      return szFileName;
+    }
+    default:
+      return names[index];
+  }
+}
+
+DWORD CascFileRefs::OpenFlags(DWORD dwFlags) const {
+  if (openType == CASC_OPEN_BY_NAME) {
+    return dwFlags;
+  }
+  return (dwFlags & ~CASC_OPEN_TYPE_MASK) | openType;
+}
+
+std::string CascKeyToString(const BYTE* key) {
+  static const char digits[] = "0123456789abcdef";
+  std::string result(MD5_HASH_SIZE * 2, '0');
+
+  for (size_t i = 0; i < MD5_HASH_SIZE; i++) {
+    result[i * 2] = digits[key[i] >> 4];
+    result[i * 2 + 1] = digits[key[i] & 0x0F];
+  }
+
+  return result;
+}
+
+bool CascLookupFile(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags, CascFileStat& stat) {
+  TCascStorage* hs = TCascStorage::IsValid(hStorage);
+  PCASC_CKEY_ENTRY pCKeyEntry = nullptr;
+
+  if (hs == nullptr || pvFileName == nullptr) {
+    return false;
+  }
+
+  switch (dwOpenFlags & CASC_OPEN_TYPE_MASK) {
+    case CASC_OPEN_BY_NAME:
+      if (hs->pRootHandler != nullptr) {
+        pCKeyEntry = hs->pRootHandler->GetFile(hs, static_cast<const char*>(pvFileName));
+      }
+      break;
+
+    case CASC_OPEN_BY_CKEY:
+      pCKeyEntry = FindCKeyEntry_CKey(hs, (LPBYTE)pvFileName);
+      break;
+
+    case CASC_OPEN_BY_EKEY:
+      pCKeyEntry = FindCKeyEntry_EKey(hs, (LPBYTE)pvFileName);
+      break;
+
+    case CASC_OPEN_BY_FILEID:
+      if (hs->pRootHandler != nullptr) {
+        pCKeyEntry = hs->pRootHandler->GetFile(hs, CASC_FILE_DATA_ID_FROM_STRING(pvFileName));
+      }
+      break;
+  }
+
+  if (pCKeyEntry == nullptr) {
+    return false;
+  }
+
+  CopyCKeyEntry(pCKeyEntry, stat);
+  return true;
+}
+
+bool CascStatFile(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags, CascFileStat& stat) {
+  if (CascLookupFile(hStorage, pvFileName, dwOpenFlags, stat) && stat.ContentSize != CASC_INVALID_SIZE64) {
+    return true;
+  }
+
+  HANDLE hFile;
+  if (!CascOpenFile(hStorage, pvFileName, CASC_LOCALE_ALL, dwOpenFlags, &hFile)) {
+    return false;
+  }
+
+  bool result = StatFileHandle(hFile, stat);
+  CascCloseFile(hFile);
+  return result;
+}
+
+bool CascLookupFileName(HANDLE hStorage, const char* szFileName, CascFileStat& stat) {
+  return CascLookupFile(hStorage, szFileName, CASC_OPEN_BY_NAME, stat);
+}
+
+bool CascStatFileName(HANDLE hStorage, const char* szFileName, CascFileStat& stat) {
+  return CascStatFile(hStorage, szFileName, CASC_OPEN_BY_NAME, stat);
+}
+
+DWORD CascOpenError(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags) {
+  CascFileStat stat;
+  return CascLookupFile(hStorage, pvFileName, dwOpenFlags, stat) ? ERROR_CAN_NOT_COMPLETE : ERROR_FILE_NOT_FOUND;
+}
+
+DWORD CascReadError(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags) {
+  HANDLE hFile = nullptr;
+  if (!CascOpenFile(hStorage, pvFileName, CASC_LOCALE_ALL, dwOpenFlags | CASC_OVERCOME_ENCRYPTED, &hFile)) {
+    return ERROR_CAN_NOT_COMPLETE;
+  }
+
+  // Encrypted frames without a key read as zeros with CASC_OVERCOME_ENCRYPTED
+  std::vector<uint8_t> buffer(0x10000);
+  DWORD chunkRead = 0;
+  bool readable;
+  while ((readable = CascReadFile(hFile, buffer.data(), (DWORD)buffer.size(), &chunkRead)) && chunkRead != 0) {
+  }
+  CascCloseFile(hFile);
+
+  return readable ? ERROR_FILE_ENCRYPTED : ERROR_FILE_CORRUPT;
+}
+
+bool CascHasNameHashes(HANDLE hStorage) {
+  DWORD features = 0;
+  size_t bytesNeeded = 0;
+
+  return CascGetStorageInfo(hStorage, CascStorageFeatures, &features, sizeof(features), &bytesNeeded) &&
+         (features & CASC_FEATURE_FNAME_HASHES) != 0;
+}
+
+HANDLE CascFindFirstFileLocked(CascRootLock& rootLock, CascStats* stats, HANDLE hStorage, LPCSTR szMask,
+                               PCASC_FIND_DATA pFindData, LPCTSTR szListFile) {
+  if (szListFile != nullptr) {
+    std::unique_lock<CascRootLock> guard(rootLock);
+    return CascFindFirstFileTimed(stats, hStorage, szMask, pFindData, szListFile);
+  }
+
+  std::shared_lock<CascRootLock> guard(rootLock);
+  return CascFindFirstFileTimed(stats, hStorage, szMask, pFindData, szListFile);
+}
+
+bool CascFindNextFileLocked(CascRootLock& rootLock, bool hasListFile, CascStats* stats, HANDLE hFind,
+                            PCASC_FIND_DATA pFindData) {
+  if (hasListFile) {
+    std::unique_lock<CascRootLock> guard(rootLock);
+    return CascFindNextFileTimed(stats, hFind, pFindData);
+  }
+
+  std::shared_lock<CascRootLock> guard(rootLock);
+  return CascFindNextFileTimed(stats, hFind, pFindData);
+}
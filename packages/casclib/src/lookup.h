@@ -0,0 +1,119 @@
+#ifndef CASCLIB_LOOKUP_H
+#define CASCLIB_LOOKUP_H
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CascLib.h"
+#include "stats.h"
+
+// Keys and size of a file, resolved without keeping a file handle
+struct CascFileStat {
+  BYTE CKey[MD5_HASH_SIZE];
+  BYTE EKey[MD5_HASH_SIZE];
+  ULONGLONG ContentSize;
+};
+
+// A list of files given by name, by packed 16-byte CKeys/EKeys or by FileDataId.
+// Exactly one of the vectors is used, as selected by openType.
+struct CascFileRefs {
+  std::vector<std::string> names;
+  std::vector<BYTE> keys;
+  std::vector<DWORD> fileDataIds;
+  DWORD openType = CASC_OPEN_BY_NAME;
+
+  size_t Count() const;
+
+  // The szFileName argument for CascOpenFile
+  const void* Get(size_t index) const;
+
+  // Name, lowercase hex key or FILE%08X.dat, for results and error messages
+  std::string Describe(size_t index) const;
+
+  // Replaces the open type in flags with the one matching this list.
+  // Name lists keep the caller's type so hex key strings still work.
+  DWORD OpenFlags(DWORD dwFlags) const;
+};
+
+// Formats a binary key as lowercase hex
+std::string CascKeyToString(const BYTE* key);
+
+// Resolves a file through the root handler and the CKey table only.
+// pvFileName and dwOpenFlags are interpreted as by CascOpenFile.
+bool CascLookupFile(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags, CascFileStat& stat);
+
+// Same as CascLookupFile, falling back to CascOpenFile when the lookup
+// fails or the entry carries no content size
+bool CascStatFile(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags, CascFileStat& stat);
+
+// Resolves a name through the root handler only. No file object is
+// created and the encoding entry is not opened.
+bool CascLookupFileName(HANDLE hStorage, const char* szFileName, CascFileStat& stat);
+
+// Same as CascLookupFileName, falling back to CascOpenFile for names the
+// root handler does not know (FILE%08X.dat, hex keys) or when the root
+// entry carries no content size
+bool CascStatFileName(HANDLE hStorage, const char* szFileName, CascFileStat& stat);
+
+// Error code for a CascOpenFile call that failed on a pool thread:
+// ERROR_FILE_NOT_FOUND when the file cannot be resolved, otherwise
+// ERROR_CAN_NOT_COMPLETE. Outside Windows, GetCascError() is one
+// process-wide value that another thread's failure may have overwritten,
+// so workers derive their error codes from their own calls instead.
+DWORD CascOpenError(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags);
+
+// Error code for a file that opened but failed to read: ERROR_FILE_ENCRYPTED
+// when it reads with CASC_OVERCOME_ENCRYPTED, so only a missing key stopped
+// it, otherwise ERROR_FILE_CORRUPT. Reads the file again; only call it on
+// the failure path.
+DWORD CascReadError(HANDLE hStorage, const void* pvFileName, DWORD dwOpenFlags);
+
+// True if the storage's root handler keys its names by CalcFileNameHash
+// (CASC_FEATURE_FNAME_HASHES), so CascLookupFileName finds names that no
+// listfile has supplied yet
+bool CascHasNameHashes(HANDLE hStorage);
+
+// Guards a storage's root handler against concurrent writes. A search with
+// a listfile inserts the listfile's names into the root's file tree during
+// CascFindFirstFile and CascFindNextFile, so those calls hold the lock
+// exclusively; other searches and name lookups on pool threads hold it
+// shared. Waiting writers go first: shared holders keep it for a short run
+// of lookups, and a search on the JS thread must not wait for a whole batch.
+class CascRootLock {
+public:
+  void lock() {
+    waitingWriters.fetch_add(1);
+    mutex.lock();
+    waitingWriters.fetch_sub(1);
+  }
+
+  void unlock() {
+    mutex.unlock();
+  }
+
+  void lock_shared() {
+    while (waitingWriters.load() != 0) {
+      std::this_thread::yield();
+    }
+    mutex.lock_shared();
+  }
+
+  void unlock_shared() {
+    mutex.unlock_shared();
+  }
+
+private:
+  std::shared_mutex mutex;
+  std::atomic<int> waitingWriters{0};
+};
+
+// CascFindFirstFileTimed and CascFindNextFileTimed under a root lock, held
+// exclusively when the search has a listfile
+HANDLE CascFindFirstFileLocked(CascRootLock& rootLock, CascStats* stats, HANDLE hStorage, LPCSTR szMask,
+                               PCASC_FIND_DATA pFindData, LPCTSTR szListFile);
+bool CascFindNextFileLocked(CascRootLock& rootLock, bool hasListFile, CascStats* stats, HANDLE hFind,
+                            PCASC_FIND_DATA pFindData);
+
+#endif // CASCLIB_LOOKUP_H
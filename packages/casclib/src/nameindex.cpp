@@ -0,0 +1,147 @@
+#include "nameindex.h"
+#include <algorithm>
+#include <cstring>
+
+static inline char NormalizeChar(char ch) {
+  if (ch == '\\') {
+    return '/';
+  }
+  if (ch >= 'A' && ch <= 'Z') {
+    return ch - 'A' + 'a';
+  }
+  return ch;
+}
+
+// Orders names as their normalized forms would sort, without copying them
+static int CompareNormalized(std::string_view left, std::string_view right) {
+  size_t length = std::min(left.size(), right.size());
+  for (size_t i = 0; i < length; i++) {
+    unsigned char l = static_cast<unsigned char>(NormalizeChar(left[i]));
+    unsigned char r = static_cast<unsigned char>(NormalizeChar(right[i]));
+    if (l != r) {
+      return l < r ? -1 : 1;
+    }
+  }
+  return left.size() < right.size() ? -1 : (left.size() > right.size() ? 1 : 0);
+}
+
+static bool StartsWithNormalized(std::string_view name, std::string_view key) {
+  return name.size() >= key.size() && CompareNormalized(name.substr(0, key.size()), key) == 0;
+}
+
+std::string CascNameIndex::Normalize(const std::string& name) {
+  std::string key(name);
+  for (char& ch : key) {
+    ch = NormalizeChar(ch);
+  }
+  return key;
+}
+
+bool CascNameIndex::Build(HANDLE hStorage, CascStats* stats, CascRootLock& rootLock) {
+  CASC_FIND_DATA findData = {0};
+  HANDLE hFind = CascFindFirstFileLocked(rootLock, stats, hStorage, "*", &findData, nullptr);
+  if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  // Names in enumeration order first, then copied once in sorted order
+  std::string found;
+  std::vector<uint32_t> foundOffsets(1, 0);
+  do {
+    found.append(findData.szFileName);
+    foundOffsets.push_back(static_cast<uint32_t>(found.size()));
+  } while (CascFindNextFileLocked(rootLock, false, stats, hFind, &findData));
+  CascFindClose(hFind);
+
+  auto foundName = [&](uint32_t index) {
+    return std::string_view(found.data() + foundOffsets[index], foundOffsets[index + 1] - foundOffsets[index]);
+  };
+
+  std::vector<uint32_t> order(foundOffsets.size() - 1);
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = static_cast<uint32_t>(i);
+  }
+  std::sort(order.begin(), order.end(), [&](uint32_t left, uint32_t right) {
+    return CompareNormalized(foundName(left), foundName(right)) < 0;
+  });
+
+  names.clear();
+  names.reserve(found.size());
+  offsets.assign(1, 0);
+  std::string_view last;
+  for (uint32_t index : order) {
+    std::string_view name = foundName(index);
+    if (offsets.size() > 1 && CompareNormalized(name, last) == 0) {
+      continue;
+    }
+    names.append(name);
+    offsets.push_back(static_cast<uint32_t>(names.size()));
+    last = name;
+  }
+  names.shrink_to_fit();
+  return true;
+}
+
+size_t CascNameIndex::Count() const {
+  return offsets.size() - 1;
+}
+
+std::string_view CascNameIndex::NameAt(size_t position) const {
+  return std::string_view(names.data() + offsets[position], offsets[position + 1] - offsets[position]);
+}
+
+size_t CascNameIndex::LowerBound(std::string_view key) const {
+  size_t low = 0;
+  size_t high = Count();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (CompareNormalized(NameAt(middle), key) < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void CascNameIndex::FindPrefix(const std::string& prefix, std::vector<std::string>& matches) const {
+  std::string key = Normalize(prefix);
+
+  for (size_t position = LowerBound(key); position < Count(); position++) {
+    std::string_view name = NameAt(position);
+    if (!StartsWithNormalized(name, key)) {
+      break;
+    }
+    matches.emplace_back(name);
+  }
+}
+
+void CascNameIndex::ListDirectory(const std::string& path, std::vector<std::string>& directories,
+                                  std::vector<std::string>& files) const {
+  std::string prefix = Normalize(path);
+  while (!prefix.empty() && prefix.back() == '/') {
+    prefix.pop_back();
+  }
+  if (!prefix.empty()) {
+    prefix.push_back('/');
+  }
+
+  size_t position = LowerBound(prefix);
+  while (position < Count()) {
+    std::string_view name = NameAt(position);
+    if (!StartsWithNormalized(name, prefix)) {
+      break;
+    }
+
+    size_t slash = name.find_first_of("/\\", prefix.size());
+    if (slash == std::string_view::npos) {
+      files.emplace_back(name.substr(prefix.size()));
+      position++;
+      continue;
+    }
+
+    // Skip the whole subtree: '0' sorts right after '/'
+    directories.emplace_back(name.substr(prefix.size(), slash - prefix.size()));
+    position = LowerBound(Normalize(std::string(name.substr(0, slash))) + '0');
+  }
+}
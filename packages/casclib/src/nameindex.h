@@ -0,0 +1,41 @@
+#ifndef CASCLIB_NAMEINDEX_H
+#define CASCLIB_NAMEINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CascLib.h"
+#include "lookup.h"
+#include "stats.h"
+
+// Names of every entry of a storage, sorted by normalized name (ASCII
+// lowercase, '\' as '/') and stored back to back. Only the names are kept;
+// find data is not. Built with one full enumeration on a worker thread; after
+// that, prefix and directory queries are binary searches over the matching
+// range only.
+class CascNameIndex {
+public:
+  // Enumerates the storage. Returns false if the search cannot be started.
+  bool Build(HANDLE hStorage, CascStats* stats, CascRootLock& rootLock);
+
+  size_t Count() const;
+
+  // Appends every name that starts with prefix, in name order
+  void FindPrefix(const std::string& prefix, std::vector<std::string>& matches) const;
+
+  // Names of the direct subdirectories and files of a directory ("" is the
+  // root), in name order. Each name is listed once.
+  void ListDirectory(const std::string& path, std::vector<std::string>& directories,
+                     std::vector<std::string>& files) const;
+
+  static std::string Normalize(const std::string& name);
+
+private:
+  std::string_view NameAt(size_t position) const;
+  size_t LowerBound(std::string_view key) const;
+
+  std::string names;              // Sorted names, back to back; storages list a name once per locale, kept once
+  std::vector<uint32_t> offsets;  // Count() + 1 offsets into names
+};
+
+#endif // CASCLIB_NAMEINDEX_H
@@ -0,0 +1,64 @@
+#ifndef CASCLIB_PARALLEL_H
+#define CASCLIB_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Number of worker threads used when the caller does not specify one
+inline size_t DefaultThreadCount() {
+  unsigned int count = std::thread::hardware_concurrency();
+  return count ? count : 4;
+}
+
+// Caps a caller-supplied thread count for CPU-bound work at the core count
+inline size_t ClampThreadCount(size_t requested) {
+  return std::max<size_t>(1, std::min(requested, DefaultThreadCount()));
+}
+
+// Calls fn(workerIndex, begin, end) for consecutive runs of up to chunkSize
+// items on up to threadCount threads. Runs are handed out from a shared
+// counter, one fetch_add per run, so cheap items can be batched while one
+// slow run still does not hold back a whole slice. The calling thread is
+// worker 0. Setting abort stops workers from picking up further runs.
+template <typename Fn>
+void ParallelForChunks(size_t threadCount, size_t itemCount, size_t chunkSize, const std::atomic<bool>& abort, Fn fn) {
+  std::atomic<size_t> nextItem(0);
+  chunkSize = std::max<size_t>(1, chunkSize);
+
+  auto run = [&](size_t workerIndex) {
+    while (!abort.load(std::memory_order_relaxed)) {
+      size_t begin = nextItem.fetch_add(chunkSize);
+      if (begin >= itemCount) {
+        break;
+      }
+      fn(workerIndex, begin, std::min(begin + chunkSize, itemCount));
+    }
+  };
+
+  threadCount = std::max<size_t>(1, std::min(threadCount, (itemCount + chunkSize - 1) / chunkSize));
+
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount - 1);
+  for (size_t i = 1; i < threadCount; i++) {
+    threads.emplace_back(run, i);
+  }
+
+  run(0);
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+// Calls fn(workerIndex, itemIndex) for every item on up to threadCount threads.
+// Items are handed out one at a time, for work where each item is expensive.
+template <typename Fn>
+void ParallelFor(size_t threadCount, size_t itemCount, const std::atomic<bool>& abort, Fn fn) {
+  ParallelForChunks(threadCount, itemCount, 1, abort, [&](size_t workerIndex, size_t begin, size_t) {
+    fn(workerIndex, begin);
+  });
+}
+
+#endif // CASCLIB_PARALLEL_H
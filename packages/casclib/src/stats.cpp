@@ -0,0 +1,189 @@
+#include "stats.h"
+#include "CascCommon.h"
+
+static void AtomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+  uint64_t current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+CascTimeHistogram::CascTimeHistogram() {
+  Reset();
+}
+
+void CascTimeHistogram::Record(uint64_t micros) {
+  size_t bucket = 0;
+  for (uint64_t value = micros >> 1; value != 0 && bucket < kBucketCount - 1; value >>= 1) {
+    bucket++;
+  }
+
+  count.fetch_add(1, std::memory_order_relaxed);
+  totalMicros.fetch_add(micros, std::memory_order_relaxed);
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  AtomicMax(maxMicros, micros);
+}
+
+void CascTimeHistogram::Reset() {
+  count.store(0, std::memory_order_relaxed);
+  totalMicros.store(0, std::memory_order_relaxed);
+  maxMicros.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < kBucketCount; i++) {
+    buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+Napi::Object CascTimeHistogram::ToObject(Napi::Env env) const {
+  Napi::Object result = Napi::Object::New(env);
+  Napi::Array bucketArray = Napi::Array::New(env, kBucketCount);
+
+  for (size_t i = 0; i < kBucketCount; i++) {
+    bucketArray.Set((uint32_t)i, Napi::Number::New(env, (double)buckets[i].load(std::memory_order_relaxed)));
+  }
+
+  result.Set("count", Napi::Number::New(env, (double)count.load(std::memory_order_relaxed)));
+  result.Set("totalMicros", Napi::Number::New(env, (double)totalMicros.load(std::memory_order_relaxed)));
+  result.Set("maxMicros", Napi::Number::New(env, (double)maxMicros.load(std::memory_order_relaxed)));
+  result.Set("buckets", bucketArray);
+  return result;
+}
+
+CascStats::CascStats() {
+  Reset();
+}
+
+void CascStats::Reset() {
+  std::atomic<uint64_t>* counters[] = {
+    &storageOpens, &filesOpened, &filesClosed, &openFailures, &encodedBytesOpened,
+    &contentBytesOpened, &lookups, &lookupFailures, &reads, &readFailures, &encryptedFailures, &bytesRead,
+    &finds, &findEntries
+  };
+
+  for (std::atomic<uint64_t>* counter : counters) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+
+  storageOpenTime.Reset();
+  openTime.Reset();
+  readTime.Reset();
+  findTime.Reset();
+}
+
+Napi::Object CascStats::ToObject(Napi::Env env) const {
+  Napi::Object result = Napi::Object::New(env);
+  auto set = [&](const char* name, const std::atomic<uint64_t>& counter) {
+    result.Set(name, Napi::Number::New(env, (double)counter.load(std::memory_order_relaxed)));
+  };
+
+  set("storageOpens", storageOpens);
+  set("filesOpened", filesOpened);
+  set("filesClosed", filesClosed);
+  set("openFailures", openFailures);
+  set("encodedBytesOpened", encodedBytesOpened);
+  set("contentBytesOpened", contentBytesOpened);
+  set("lookups", lookups);
+  set("lookupFailures", lookupFailures);
+  set("reads", reads);
+  set("readFailures", readFailures);
+  set("encryptedFailures", encryptedFailures);
+  set("bytesRead", bytesRead);
+  set("finds", finds);
+  set("findEntries", findEntries);
+  result.Set("storageOpenTime", storageOpenTime.ToObject(env));
+  result.Set("openTime", openTime.ToObject(env));
+  result.Set("readTime", readTime.ToObject(env));
+  result.Set("findTime", findTime.ToObject(env));
+  return result;
+}
+
+bool CascOpenFileTimed(CascStats* stats, HANDLE hStorage, const void* pvFileName, DWORD dwLocaleFlags,
+                       DWORD dwOpenFlags, HANDLE* PtrFileHandle) {
+  if (stats == nullptr) {
+    return CascOpenFile(hStorage, pvFileName, dwLocaleFlags, dwOpenFlags, PtrFileHandle);
+  }
+
+  CascStopwatch stopwatch;
+  bool result = CascOpenFile(hStorage, pvFileName, dwLocaleFlags, dwOpenFlags, PtrFileHandle);
+  stats->openTime.Record(stopwatch.Micros());
+
+  if (!result) {
+    stats->openFailures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Sizes are known from the ENCODING entry; online files may not have them yet
+  stats->filesOpened.fetch_add(1, std::memory_order_relaxed);
+  TCascFile* hf = TCascFile::IsValid(*PtrFileHandle);
+  if (hf != nullptr) {
+    if (hf->EncodedSize != CASC_INVALID_SIZE64) {
+      stats->encodedBytesOpened.fetch_add(hf->EncodedSize, std::memory_order_relaxed);
+    }
+    if (hf->ContentSize != CASC_INVALID_SIZE64) {
+      stats->contentBytesOpened.fetch_add(hf->ContentSize, std::memory_order_relaxed);
+    }
+  }
+
+  return true;
+}
+
+bool CascReadFileTimed(CascStats* stats, HANDLE hFile, void* lpBuffer, DWORD dwToRead, PDWORD pdwRead) {
+  if (stats == nullptr) {
+    return CascReadFile(hFile, lpBuffer, dwToRead, pdwRead);
+  }
+
+  CascStopwatch stopwatch;
+  bool result = CascReadFile(hFile, lpBuffer, dwToRead, pdwRead);
+  stats->readTime.Record(stopwatch.Micros());
+  stats->reads.fetch_add(1, std::memory_order_relaxed);
+
+  if (!result) {
+    stats->readFailures.fetch_add(1, std::memory_order_relaxed);
+    if (GetCascError() == ERROR_FILE_ENCRYPTED) {
+      stats->encryptedFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+  }
+
+  if (pdwRead != nullptr) {
+    stats->bytesRead.fetch_add(*pdwRead, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+bool CascCloseFileCounted(CascStats* stats, HANDLE hFile) {
+  if (stats != nullptr) {
+    stats->filesClosed.fetch_add(1, std::memory_order_relaxed);
+  }
+  return CascCloseFile(hFile);
+}
+
+HANDLE CascFindFirstFileTimed(CascStats* stats, HANDLE hStorage, LPCSTR szMask, PCASC_FIND_DATA pFindData,
+                              LPCTSTR szListFile) {
+  if (stats == nullptr) {
+    return CascFindFirstFile(hStorage, szMask, pFindData, szListFile);
+  }
+
+  CascStopwatch stopwatch;
+  HANDLE hFind = CascFindFirstFile(hStorage, szMask, pFindData, szListFile);
+  stats->findTime.Record(stopwatch.Micros());
+  stats->finds.fetch_add(1, std::memory_order_relaxed);
+
+  if (hFind != nullptr && hFind != INVALID_HANDLE_VALUE) {
+    stats->findEntries.fetch_add(1, std::memory_order_relaxed);
+  }
+  return hFind;
+}
+
+bool CascFindNextFileTimed(CascStats* stats, HANDLE hFind, PCASC_FIND_DATA pFindData) {
+  if (stats == nullptr) {
+    return CascFindNextFile(hFind, pFindData);
+  }
+
+  CascStopwatch stopwatch;
+  bool result = CascFindNextFile(hFind, pFindData);
+  stats->findTime.Record(stopwatch.Micros());
+
+  if (result) {
+    stats->findEntries.fetch_add(1, std::memory_order_relaxed);
+  }
+  return result;
+}
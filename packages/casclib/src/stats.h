@@ -0,0 +1,93 @@
+#ifndef CASCLIB_STATS_H
+#define CASCLIB_STATS_H
+
+#include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "CascLib.h"
+
+// Histogram of call durations. Bucket i counts calls that took less than
+// 2^(i+1) microseconds (and at least 2^i for i > 0); the last bucket also
+// holds everything slower.
+class CascTimeHistogram {
+public:
+  static const size_t kBucketCount = 24;
+
+  CascTimeHistogram();
+
+  void Record(uint64_t micros);
+  void Reset();
+  Napi::Object ToObject(Napi::Env env) const;
+
+private:
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> totalMicros;
+  std::atomic<uint64_t> maxMicros;
+  std::atomic<uint64_t> buckets[kBucketCount];
+};
+
+// Per-storage counters, updated with relaxed atomics from any thread.
+// Shared with the files and iterators of the storage, so they keep
+// counting after the storage object is gone.
+class CascStats {
+public:
+  CascStats();
+
+  void Reset();
+  Napi::Object ToObject(Napi::Env env) const;
+
+  // Storage opens
+  std::atomic<uint64_t> storageOpens;
+  CascTimeHistogram storageOpenTime;
+
+  // File handles
+  std::atomic<uint64_t> filesOpened;
+  std::atomic<uint64_t> filesClosed;
+  std::atomic<uint64_t> openFailures;
+  std::atomic<uint64_t> encodedBytesOpened;
+  std::atomic<uint64_t> contentBytesOpened;
+  CascTimeHistogram openTime;
+
+  // Existence and stat checks
+  std::atomic<uint64_t> lookups;
+  std::atomic<uint64_t> lookupFailures;
+
+  // CascReadFile calls; the time covers data file I/O, decompression and decryption
+  std::atomic<uint64_t> reads;
+  std::atomic<uint64_t> readFailures;
+  std::atomic<uint64_t> encryptedFailures;
+  std::atomic<uint64_t> bytesRead;
+  CascTimeHistogram readTime;
+
+  // CascFindFirstFile/CascFindNextFile calls
+  std::atomic<uint64_t> finds;
+  std::atomic<uint64_t> findEntries;
+  CascTimeHistogram findTime;
+};
+
+// Measures the time since construction
+class CascStopwatch {
+public:
+  CascStopwatch() : start(std::chrono::steady_clock::now()) {}
+
+  uint64_t Micros() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start;
+};
+
+// CascLib calls that update the counters of stats. stats may be nullptr,
+// e.g. for files opened with CascOpenLocalFile.
+bool CascOpenFileTimed(CascStats* stats, HANDLE hStorage, const void* pvFileName, DWORD dwLocaleFlags,
+                       DWORD dwOpenFlags, HANDLE* PtrFileHandle);
+bool CascReadFileTimed(CascStats* stats, HANDLE hFile, void* lpBuffer, DWORD dwToRead, PDWORD pdwRead);
+bool CascCloseFileCounted(CascStats* stats, HANDLE hFile);
+HANDLE CascFindFirstFileTimed(CascStats* stats, HANDLE hStorage, LPCSTR szMask, PCASC_FIND_DATA pFindData,
+                              LPCTSTR szListFile);
+bool CascFindNextFileTimed(CascStats* stats, HANDLE hFind, PCASC_FIND_DATA pFindData);
+
+#endif // CASCLIB_STATS_H
@@ -1,9 +1,122 @@
 #include "storage.h"
 #include "file.h"
+#include "workers.h"
+#include "find.h"
+#include "lookup.h"
+#include "parallel.h"
+#include <cstring>
 #include <string>
+#include <vector>
 
 Napi::FunctionReference CascStorage::constructor;
 
+// Reads the CascOpenStorageEx options object
+static void GetOpenStorageParams(const Napi::Object& options, OpenStorageParams& params) {
+  // localPath is not used; the params string is the local path
+  if (options.Has("codeName") && options.Get("codeName").IsString()) {
+    params.codeName = options.Get("codeName").As<Napi::String>().Utf8Value();
+  }
+
+  if (options.Has("region") && options.Get("region").IsString()) {
+    params.region = options.Get("region").As<Napi::String>().Utf8Value();
+  }
+
+  if (options.Has("localeMask") && options.Get("localeMask").IsNumber()) {
+    params.localeMask = options.Get("localeMask").As<Napi::Number>().Uint32Value();
+  }
+
+  if (options.Has("flags") && options.Get("flags").IsNumber()) {
+    params.flags = options.Get("flags").As<Napi::Number>().Uint32Value();
+  }
+
+  if (options.Has("buildKey") && options.Get("buildKey").IsString()) {
+    params.buildKey = options.Get("buildKey").As<Napi::String>().Utf8Value();
+  }
+
+  if (options.Has("cdnHostUrl") && options.Get("cdnHostUrl").IsString()) {
+    params.cdnHostUrl = options.Get("cdnHostUrl").As<Napi::String>().Utf8Value();
+  }
+
+  if (options.Has("online") && options.Get("online").IsBoolean()) {
+    params.online = options.Get("online").As<Napi::Boolean>().Value();
+  }
+}
+
+// Converts a JS array of strings; returns false if any element is not a string
+static bool GetStringArray(const Napi::Value& value, std::vector<std::string>& strings) {
+  Napi::Array array = value.As<Napi::Array>();
+  strings.reserve(array.Length());
+
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value item = array.Get(i);
+    if (!item.IsString()) {
+      return false;
+    }
+    strings.push_back(item.As<Napi::String>().Utf8Value());
+  }
+
+  return true;
+}
+
+// Converts a file name, a 16-byte CKey/EKey Buffer or a FileDataId number.
+// dwFlags picks CKey or EKey for a key Buffer.
+static bool GetFileRef(const Napi::Value& value, DWORD dwFlags, CascFileRefs& refs) {
+  if (value.IsString()) {
+    refs.openType = CASC_OPEN_BY_NAME;
+    refs.names.push_back(value.As<Napi::String>().Utf8Value());
+    return true;
+  }
+
+  if (value.IsNumber()) {
+    refs.openType = CASC_OPEN_BY_FILEID;
+    refs.fileDataIds.push_back(value.As<Napi::Number>().Uint32Value());
+    return true;
+  }
+
+  if (value.IsBuffer()) {
+    Napi::Buffer<BYTE> key = value.As<Napi::Buffer<BYTE>>();
+    if (key.Length() != MD5_HASH_SIZE) {
+      return false;
+    }
+    refs.openType = ((dwFlags & CASC_OPEN_TYPE_MASK) == CASC_OPEN_BY_EKEY) ? CASC_OPEN_BY_EKEY : CASC_OPEN_BY_CKEY;
+    refs.keys.assign(key.Data(), key.Data() + MD5_HASH_SIZE);
+    return true;
+  }
+
+  return false;
+}
+
+// Converts an array of names, a Buffer of packed 16-byte keys or a
+// Uint32Array of FileDataIds. dwFlags picks CKey or EKey for key Buffers.
+static bool GetFileRefs(const Napi::Value& value, DWORD dwFlags, CascFileRefs& refs) {
+  if (value.IsArray()) {
+    refs.openType = CASC_OPEN_BY_NAME;
+    return GetStringArray(value, refs.names);
+  }
+
+  if (!value.IsTypedArray()) {
+    return false;
+  }
+
+  Napi::TypedArray array = value.As<Napi::TypedArray>();
+  const uint8_t* data = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+
+  if (array.TypedArrayType() == napi_uint8_array && array.ByteLength() % MD5_HASH_SIZE == 0) {
+    refs.openType = ((dwFlags & CASC_OPEN_TYPE_MASK) == CASC_OPEN_BY_EKEY) ? CASC_OPEN_BY_EKEY : CASC_OPEN_BY_CKEY;
+    refs.keys.assign(data, data + array.ByteLength());
+    return true;
+  }
+
+  if (array.TypedArrayType() == napi_uint32_array) {
+    const DWORD* fileDataIds = reinterpret_cast<const DWORD*>(data);
+    refs.openType = CASC_OPEN_BY_FILEID;
+    refs.fileDataIds.assign(fileDataIds, fileDataIds + array.ElementLength());
+    return true;
+  }
+
+  return false;
+}
+
 Napi::Object CascStorage::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
 
@@ -11,14 +124,28 @@ Napi::Object CascStorage::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("CascOpenStorage", &CascStorage::Open),
     InstanceMethod("CascOpenOnlineStorage", &CascStorage::OpenOnline),
     InstanceMethod("CascOpenStorageEx", &CascStorage::OpenEx),
+    InstanceMethod("openAsync", &CascStorage::OpenAsync),
     InstanceMethod("CascCloseStorage", &CascStorage::Close),
     InstanceMethod("CascOpenFile", &CascStorage::OpenFile),
     InstanceMethod("CascGetFileInfo", &CascStorage::GetFileInfo),
     InstanceMethod("fileExists", &CascStorage::FileExists),
+    InstanceMethod("existsMany", &CascStorage::ExistsMany),
+    InstanceMethod("statMany", &CascStorage::StatMany),
     InstanceMethod("CascGetStorageInfo", &CascStorage::GetStorageInfo),
+    InstanceMethod("readFiles", &CascStorage::ReadFiles),
+    InstanceMethod("verifyAll", &CascStorage::VerifyAll),
+    InstanceMethod("extract", &CascStorage::Extract),
+    InstanceMethod("matchNameHashes", &CascStorage::MatchNameHashes),
+    InstanceMethod("getStats", &CascStorage::GetStats),
+    InstanceMethod("resetStats", &CascStorage::ResetStats),
     InstanceMethod("CascFindFirstFile", &CascStorage::FindFirstFile),
     InstanceMethod("CascFindNextFile", &CascStorage::FindNextFile),
     InstanceMethod("CascFindClose", &CascStorage::FindClose),
+    InstanceMethod("findBatch", &CascStorage::FindBatch),
+    InstanceMethod("createFindIterator", &CascStorage::CreateFindIterator),
+    InstanceMethod("buildNameIndex", &CascStorage::BuildNameIndex),
+    InstanceMethod("findPrefix", &CascStorage::FindPrefix),
+    InstanceMethod("listDirectory", &CascStorage::ListDirectory),
     InstanceMethod("CascAddEncryptionKey", &CascStorage::AddEncryptionKey),
     InstanceMethod("CascAddStringEncryptionKey", &CascStorage::AddStringEncryptionKey),
     InstanceMethod("CascImportKeysFromString", &CascStorage::ImportKeysFromString),
@@ -35,7 +162,8 @@ Napi::Object CascStorage::Init(Napi::Env env, Napi::Object exports) {
 }
 
 CascStorage::CascStorage(const Napi::CallbackInfo& info) 
-  : Napi::ObjectWrap<CascStorage>(info), hStorage(nullptr), hFind(nullptr), isOpen(false), isFindOpen(false) {
+  : Napi::ObjectWrap<CascStorage>(info), hStorage(nullptr), hFind(nullptr), isOpen(false), isFindOpen(false), findHasListFile(false),
+    pendingOps(0), stats(std::make_shared<CascStats>()), rootLock(std::make_shared<CascRootLock>()) {
   Napi::Env env = info.Env();
   
   if (info.Length() > 0) {
@@ -79,6 +207,12 @@ Napi::Value CascStorage::Open(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (pendingOps > 0) {
+    Napi::Error::New(env, "Storage has pending asynchronous operations")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   std::string path = info[0].As<Napi::String>().Utf8Value();
   DWORD flags = 0;
 
@@ -86,12 +220,15 @@ Napi::Value CascStorage::Open(const Napi::CallbackInfo& info) {
     flags = info[1].As<Napi::Number>().Uint32Value();
   }
 
+  CascStopwatch stopwatch;
   if (!CascOpenStorage(path.c_str(), flags, &hStorage)) {
     std::string error = "Failed to open CASC storage: " + path;
     Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Null();
   }
 
+  stats->storageOpens++;
+  stats->storageOpenTime.Record(stopwatch.Micros());
   isOpen = true;
   return Napi::Boolean::New(env, true);
 }
@@ -103,12 +240,19 @@ Napi::Value CascStorage::Close(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, false);
   }
 
+  if (pendingOps > 0) {
+    Napi::Error::New(env, "Storage has pending asynchronous operations")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   if (hStorage) {
     CascCloseStorage(hStorage);
     hStorage = nullptr;
     isOpen = false;
   }
 
+  nameIndex.reset();
   return Napi::Boolean::New(env, true);
 }
 
@@ -121,28 +265,27 @@ Napi::Value CascStorage::OpenFile(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Expected filename as first argument")
-      .ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  std::string filename = info[0].As<Napi::String>().Utf8Value();
   DWORD dwFlags = CASC_OPEN_BY_NAME;
-
   if (info.Length() > 1 && info[1].IsNumber()) {
     dwFlags = info[1].As<Napi::Number>().Uint32Value();
   }
 
+  CascFileRefs refs;
+  if (info.Length() < 1 || !GetFileRef(info[0], dwFlags, refs)) {
+    Napi::TypeError::New(env, "Expected filename, 16-byte key Buffer or FileDataId as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   HANDLE hFile;
-  if (!CascOpenFile(hStorage, filename.c_str(), CASC_LOCALE_ALL, dwFlags, &hFile)) {
-    std::string error = "Failed to open file: " + filename;
+  if (!CascOpenFileTimed(stats.get(), hStorage, refs.Get(0), CASC_LOCALE_ALL, refs.OpenFlags(dwFlags), &hFile)) {
+    std::string error = "Failed to open file: " + refs.Describe(0);
     Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Null();
   }
 
   // Create a CascFile object
-  Napi::Object fileObj = CascFile::NewInstance(env, hFile);
+  Napi::Object fileObj = CascFile::NewInstance(env, hFile, stats);
   return fileObj;
 }
 
@@ -162,20 +305,19 @@ Napi::Value CascStorage::GetFileInfo(const Napi::CallbackInfo& info) {
   }
 
   std::string filename = info[0].As<Napi::String>().Utf8Value();
-  
-  HANDLE hFile;
-  if (!CascOpenFile(hStorage, filename.c_str(), CASC_LOCALE_ALL, CASC_OPEN_BY_NAME, &hFile)) {
+
+  // Resolved from the root and encoding tables, without a file handle
+  CascFileStat stat;
+  stats->lookups++;
+  if (!CascStatFileName(hStorage, filename.c_str(), stat)) {
+    stats->lookupFailures++;
     return env.Null();
   }
 
-  DWORD fileSize = CascGetFileSize(hFile, nullptr);
-  
   Napi::Object result = Napi::Object::New(env);
   result.Set("name", Napi::String::New(env, filename));
-  result.Set("size", Napi::Number::New(env, fileSize));
+  result.Set("size", Napi::Number::New(env, (double)stat.ContentSize));
 
-  CascCloseFile(hFile);
-  
   return result;
 }
 
@@ -188,22 +330,303 @@ Napi::Value CascStorage::FileExists(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  if (info.Length() < 1 || !info[0].IsString()) {
-    Napi::TypeError::New(env, "Expected filename as first argument")
+  DWORD dwFlags = CASC_OPEN_BY_NAME;
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    dwFlags = info[1].As<Napi::Number>().Uint32Value();
+  }
+
+  CascFileRefs refs;
+  if (info.Length() < 1 || !GetFileRef(info[0], dwFlags, refs)) {
+    Napi::TypeError::New(env, "Expected filename, 16-byte key Buffer or FileDataId as first argument")
       .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  std::string filename = info[0].As<Napi::String>().Utf8Value();
-  
+  return Napi::Boolean::New(env, FileExistsByRef(refs.Get(0), refs.OpenFlags(dwFlags)));
+}
+
+bool CascStorage::FileExistsByRef(const void* pvFileName, DWORD dwOpenFlags) {
+  CascFileStat stat;
+
+  stats->lookups++;
+  if (CascLookupFile(hStorage, pvFileName, dwOpenFlags, stat)) {
+    return true;
+  }
+
+  // Names the root does not know (FILE%08X.dat, hex keys) are resolved by CascOpenFile
   HANDLE hFile;
-  bool exists = CascOpenFile(hStorage, filename.c_str(), CASC_LOCALE_ALL, CASC_OPEN_BY_NAME, &hFile);
-  
+  bool exists = CascOpenFile(hStorage, pvFileName, CASC_LOCALE_ALL, dwOpenFlags, &hFile);
+
   if (exists) {
     CascCloseFile(hFile);
+  } else {
+    stats->lookupFailures++;
+  }
+
+  return exists;
+}
+
+Napi::Value CascStorage::ExistsMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD dwFlags = CASC_OPEN_BY_NAME;
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    dwFlags = info[1].As<Napi::Number>().Uint32Value();
+  }
+
+  CascFileRefs refs;
+  if (info.Length() < 1 || !GetFileRefs(info[0], dwFlags, refs)) {
+    Napi::TypeError::New(env, "Expected array of file names, packed key Buffer or Uint32Array of FileDataIds as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD dwOpenFlags = refs.OpenFlags(dwFlags);
+
+  Napi::Uint8Array result = Napi::Uint8Array::New(env, refs.Count());
+  for (size_t i = 0; i < refs.Count(); i++) {
+    result[i] = FileExistsByRef(refs.Get(i), dwOpenFlags) ? 1 : 0;
+  }
+
+  return result;
+}
+
+Napi::Value CascStorage::StatMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD dwFlags = CASC_OPEN_BY_NAME;
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    dwFlags = info[1].As<Napi::Number>().Uint32Value();
+  }
+
+  CascFileRefs refs;
+  if (info.Length() < 1 || !GetFileRefs(info[0], dwFlags, refs)) {
+    Napi::TypeError::New(env, "Expected array of file names, packed key Buffer or Uint32Array of FileDataIds as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD dwOpenFlags = refs.OpenFlags(dwFlags);
+
+  size_t count = refs.Count();
+  Napi::Uint8Array found = Napi::Uint8Array::New(env, count);
+  Napi::Float64Array sizes = Napi::Float64Array::New(env, count);
+  Napi::Buffer<BYTE> ckeys = Napi::Buffer<BYTE>::New(env, count * MD5_HASH_SIZE);
+  Napi::Buffer<BYTE> ekeys = Napi::Buffer<BYTE>::New(env, count * MD5_HASH_SIZE);
+
+  for (size_t i = 0; i < count; i++) {
+    CascFileStat stat;
+    BYTE* ckey = ckeys.Data() + i * MD5_HASH_SIZE;
+    BYTE* ekey = ekeys.Data() + i * MD5_HASH_SIZE;
+
+    stats->lookups++;
+    if (CascStatFile(hStorage, refs.Get(i), dwOpenFlags, stat)) {
+      found[i] = 1;
+      sizes[i] = (double)stat.ContentSize;
+      memcpy(ckey, stat.CKey, MD5_HASH_SIZE);
+      memcpy(ekey, stat.EKey, MD5_HASH_SIZE);
+    } else {
+      stats->lookupFailures++;
+      found[i] = 0;
+      sizes[i] = 0;
+      memset(ckey, 0, MD5_HASH_SIZE);
+      memset(ekey, 0, MD5_HASH_SIZE);
+    }
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("found", found);
+  result.Set("sizes", sizes);
+  result.Set("ckeys", ckeys);
+  result.Set("ekeys", ekeys);
+  return result;
+}
+
+Napi::Value CascStorage::ReadFiles(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (info.Length() < 4 || !info[3].IsFunction()) {
+    Napi::TypeError::New(env, "Expected callback as fourth argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  DWORD dwFlags = CASC_OPEN_BY_NAME;
+  if (info[2].IsNumber()) {
+    dwFlags = info[2].As<Napi::Number>().Uint32Value();
+  }
+
+  CascFileRefs refs;
+  if (!GetFileRefs(info[0], dwFlags, refs)) {
+    Napi::TypeError::New(env, "Expected array of file names, packed key Buffer or Uint32Array of FileDataIds as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Decoding is CPU bound, so more threads than cores only add contention
+  size_t concurrency = DefaultThreadCount();
+  if (info[1].IsNumber() && info[1].As<Napi::Number>().Uint32Value() > 0) {
+    concurrency = ClampThreadCount(info[1].As<Napi::Number>().Uint32Value());
+  }
+
+  size_t window = 0;
+  if (info.Length() > 4 && info[4].IsNumber()) {
+    window = info[4].As<Napi::Number>().Uint32Value();
   }
 
-  return Napi::Boolean::New(env, exists);
+  DWORD dwOpenFlags = refs.OpenFlags(dwFlags);
+  ReadFilesWorker* worker = new ReadFilesWorker(env, this, std::move(refs), dwOpenFlags,
+                                                concurrency, window, info[3].As<Napi::Function>());
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascStorage::VerifyAll(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string mask = "*";
+  if (info.Length() > 0 && info[0].IsString()) {
+    mask = info[0].As<Napi::String>().Utf8Value();
+  }
+
+  size_t threads = DefaultThreadCount();
+  if (info.Length() > 1 && info[1].IsNumber() && info[1].As<Napi::Number>().Uint32Value() > 0) {
+    threads = ClampThreadCount(info[1].As<Napi::Number>().Uint32Value());
+  }
+
+  std::string listFile;
+  if (info.Length() > 2 && info[2].IsString()) {
+    listFile = info[2].As<Napi::String>().Utf8Value();
+  }
+
+  Napi::Function onProgress;
+  if (info.Length() > 3 && info[3].IsFunction()) {
+    onProgress = info[3].As<Napi::Function>();
+  }
+
+  VerifyWorker* worker = new VerifyWorker(env, this, std::move(mask), std::move(listFile), threads, onProgress);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascStorage::Extract(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    Napi::TypeError::New(env, "Expected mask and output directory as arguments")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string mask = info[0].As<Napi::String>().Utf8Value();
+  std::string outDir = info[1].As<Napi::String>().Utf8Value();
+
+  size_t threads = DefaultThreadCount();
+  if (info.Length() > 2 && info[2].IsNumber() && info[2].As<Napi::Number>().Uint32Value() > 0) {
+    threads = ClampThreadCount(info[2].As<Napi::Number>().Uint32Value());
+  }
+
+  std::string listFile;
+  if (info.Length() > 3 && info[3].IsString()) {
+    listFile = info[3].As<Napi::String>().Utf8Value();
+  }
+
+  Napi::Function onProgress;
+  if (info.Length() > 4 && info[4].IsFunction()) {
+    onProgress = info[4].As<Napi::Function>();
+  }
+
+  ExtractWorker* worker = new ExtractWorker(env, this, std::move(mask), std::move(outDir), std::move(listFile),
+                                            threads, onProgress);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascStorage::MatchNameHashes(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!CascHasNameHashes(hStorage)) {
+    Napi::Error::New(env, "Storage does not key file names by hash (CASC_FEATURE_FNAME_HASHES)")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<std::string> names;
+  std::string listFile;
+  if (info.Length() > 0 && info[0].IsArray()) {
+    if (!GetStringArray(info[0], names)) {
+      Napi::TypeError::New(env, "Every candidate name must be a string")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  } else if (info.Length() > 0 && info[0].IsTypedArray() &&
+             info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+    Napi::Uint8Array content = info[0].As<Napi::Uint8Array>();
+    listFile.assign(reinterpret_cast<const char*>(content.Data()), content.ByteLength());
+  } else {
+    Napi::TypeError::New(env, "Expected array of names or listfile Buffer as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t threads = DefaultThreadCount();
+  if (info.Length() > 1 && info[1].IsNumber() && info[1].As<Napi::Number>().Uint32Value() > 0) {
+    threads = ClampThreadCount(info[1].As<Napi::Number>().Uint32Value());
+  }
+
+  MatchNameHashesWorker* worker = new MatchNameHashesWorker(env, this, hStorage, std::move(names), std::move(listFile), threads);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascStorage::GetStats(const Napi::CallbackInfo& info) {
+  // Counters survive close and reopen; only resetStats clears them
+  return stats->ToObject(info.Env());
+}
+
+Napi::Value CascStorage::ResetStats(const Napi::CallbackInfo& info) {
+  stats->Reset();
+  return info.Env().Undefined();
 }
 
 Napi::Value CascStorage::OpenOnline(const Napi::CallbackInfo& info) {
@@ -227,6 +650,12 @@ Napi::Value CascStorage::OpenOnline(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
+  if (pendingOps > 0) {
+    Napi::Error::New(env, "Storage has pending asynchronous operations")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
   std::string path = info[0].As<Napi::String>().Utf8Value();
   DWORD flags = 0;
 
@@ -234,12 +663,15 @@ Napi::Value CascStorage::OpenOnline(const Napi::CallbackInfo& info) {
     flags = info[1].As<Napi::Number>().Uint32Value();
   }
 
+  CascStopwatch stopwatch;
   if (!CascOpenOnlineStorage(path.c_str(), flags, &hStorage)) {
     std::string error = "Failed to open online CASC storage: " + path;
     Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return env.Null();
   }
 
+  stats->storageOpens++;
+  stats->storageOpenTime.Record(stopwatch.Micros());
   isOpen = true;
   return Napi::Boolean::New(env, true);
 }
@@ -265,71 +697,70 @@ Napi::Value CascStorage::OpenEx(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  std::string params = info[0].As<Napi::String>().Utf8Value();
-  
-  // Initialize CASC_OPEN_STORAGE_ARGS structure
-  CASC_OPEN_STORAGE_ARGS args = {0};
-  args.Size = sizeof(CASC_OPEN_STORAGE_ARGS);
-  args.dwLocaleMask = CASC_LOCALE_ALL;
-  args.dwFlags = 0;
-
-  bool bOnlineStorage = false;
+  if (pendingOps > 0) {
+    Napi::Error::New(env, "Storage has pending asynchronous operations")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  // If second argument is an options object
+  OpenStorageParams params;
+  params.params = info[0].As<Napi::String>().Utf8Value();
   if (info.Length() > 1 && info[1].IsObject()) {
-    Napi::Object options = info[1].As<Napi::Object>();
+    GetOpenStorageParams(info[1].As<Napi::Object>(), params);
+  }
 
-    // Extract optional parameters
-    if (options.Has("localPath") && options.Get("localPath").IsString()) {
-      // LocalPath is stored temporarily - we'll use params for szLocalPath instead
-    }
+  CASC_OPEN_STORAGE_ARGS args = {0};
+  params.FillArgs(args);
 
-    if (options.Has("codeName") && options.Get("codeName").IsString()) {
-      static std::string codeName;
-      codeName = options.Get("codeName").As<Napi::String>().Utf8Value();
-      args.szCodeName = codeName.c_str();
-    }
+  // Call CascOpenStorageEx
+  CascStopwatch stopwatch;
+  if (!CascOpenStorageEx(params.params.c_str(), &args, params.online, &hStorage)) {
+    std::string error = "Failed to open CASC storage with extended parameters: " + params.params;
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    if (options.Has("region") && options.Get("region").IsString()) {
-      static std::string region;
-      region = options.Get("region").As<Napi::String>().Utf8Value();
-      args.szRegion = region.c_str();
-    }
+  stats->storageOpens++;
+  stats->storageOpenTime.Record(stopwatch.Micros());
+  isOpen = true;
+  return Napi::Boolean::New(env, true);
+}
 
-    if (options.Has("localeMask") && options.Get("localeMask").IsNumber()) {
-      args.dwLocaleMask = options.Get("localeMask").As<Napi::Number>().Uint32Value();
-    }
+Napi::Value CascStorage::OpenAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-    if (options.Has("flags") && options.Get("flags").IsNumber()) {
-      args.dwFlags = options.Get("flags").As<Napi::Number>().Uint32Value();
-    }
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected params string as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    if (options.Has("buildKey") && options.Get("buildKey").IsString()) {
-      static std::string buildKey;
-      buildKey = options.Get("buildKey").As<Napi::String>().Utf8Value();
-      args.szBuildKey = buildKey.c_str();
-    }
+  if (isOpen) {
+    Napi::Error::New(env, "Storage is already open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    if (options.Has("cdnHostUrl") && options.Get("cdnHostUrl").IsString()) {
-      static std::string cdnHostUrl;
-      cdnHostUrl = options.Get("cdnHostUrl").As<Napi::String>().Utf8Value();
-      args.szCdnHostUrl = cdnHostUrl.c_str();
-    }
+  if (pendingOps > 0) {
+    Napi::Error::New(env, "Storage has pending asynchronous operations")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-    if (options.Has("online") && options.Get("online").IsBoolean()) {
-      bOnlineStorage = options.Get("online").As<Napi::Boolean>().Value();
-    }
+  OpenStorageParams params;
+  params.params = info[0].As<Napi::String>().Utf8Value();
+  if (info.Length() > 1 && info[1].IsObject()) {
+    GetOpenStorageParams(info[1].As<Napi::Object>(), params);
   }
 
-  // Call CascOpenStorageEx
-  if (!CascOpenStorageEx(params.c_str(), &args, bOnlineStorage, &hStorage)) {
-    std::string error = "Failed to open CASC storage with extended parameters: " + params;
-    Napi::Error::New(env, error).ThrowAsJavaScriptException();
-    return env.Null();
+  Napi::Function onProgress;
+  if (info.Length() > 2 && info[2].IsFunction()) {
+    onProgress = info[2].As<Napi::Function>();
   }
 
-  isOpen = true;
-  return Napi::Boolean::New(env, true);
+  OpenStorageWorker* worker = new OpenStorageWorker(env, this, std::move(params), onProgress);
+  worker->Queue();
+  return worker->GetPromise();
 }
 
 Napi::Value CascStorage::GetStorageInfo(const Napi::CallbackInfo& info) {
@@ -410,14 +841,23 @@ Napi::Value CascStorage::FindFirstFile(const Napi::CallbackInfo& info) {
     listFile = listFileStr.c_str();
   }
 
+  // Starting a new search ends the previous one
+  if (isFindOpen && hFind) {
+    CascFindClose(hFind);
+    hFind = nullptr;
+    isFindOpen = false;
+  }
+
   CASC_FIND_DATA findData = {0};
-  hFind = CascFindFirstFile(hStorage, mask, &findData, listFile);
+  hFind = CascFindFirstFileLocked(*rootLock, stats.get(), hStorage, mask, &findData, listFile);
 
   if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+    hFind = nullptr;
     return env.Null();
   }
 
   isFindOpen = true;
+  findHasListFile = listFile != nullptr;
 
   Napi::Object result = Napi::Object::New(env);
   result.Set("fileName", Napi::String::New(env, findData.szFileName));
@@ -446,7 +886,7 @@ Napi::Value CascStorage::FindNextFile(const Napi::CallbackInfo& info) {
   }
 
   CASC_FIND_DATA findData = {0};
-  if (!CascFindNextFile(hFind, &findData)) {
+  if (!CascFindNextFileLocked(*rootLock, findHasListFile, stats.get(), hFind, &findData)) {
     return env.Null();
   }
 
@@ -481,6 +921,199 @@ Napi::Value CascStorage::FindClose(const Napi::CallbackInfo& info) {
   return Napi::Boolean::New(env, true);
 }
 
+Napi::Value CascStorage::FindBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t maxEntries = 4096;
+  if (info.Length() > 1 && info[1].IsNumber() && info[1].As<Napi::Number>().Uint32Value() > 0) {
+    maxEntries = info[1].As<Napi::Number>().Uint32Value();
+  }
+
+  CascFindBatch batch;
+  batch.Reserve(maxEntries);
+
+  // A mask starts a new search; otherwise the current one continues
+  if (info.Length() > 0 && info[0].IsString()) {
+    std::string mask = info[0].As<Napi::String>().Utf8Value();
+    std::string listFileStr;
+    const char* listFile = nullptr;
+
+    if (info.Length() > 2 && info[2].IsString()) {
+      listFileStr = info[2].As<Napi::String>().Utf8Value();
+      listFile = listFileStr.c_str();
+    }
+
+    if (isFindOpen && hFind) {
+      CascFindClose(hFind);
+      hFind = nullptr;
+      isFindOpen = false;
+    }
+
+    CASC_FIND_DATA findData = {0};
+    hFind = CascFindFirstFileLocked(*rootLock, stats.get(), hStorage, mask.c_str(), &findData, listFile);
+
+    if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+      hFind = nullptr;
+      return env.Null();
+    }
+
+    isFindOpen = true;
+    findHasListFile = listFile != nullptr;
+    batch.Append(findData);
+  }
+
+  if (!isFindOpen || !hFind) {
+    return env.Null();
+  }
+
+  if (!CascFindNextBatch(*rootLock, findHasListFile, hFind, maxEntries, batch, stats.get())) {
+    CascFindClose(hFind);
+    hFind = nullptr;
+    isFindOpen = false;
+  }
+
+  if (batch.Count() == 0) {
+    return env.Null();
+  }
+
+  return batch.ToObject(env);
+}
+
+Napi::Value CascStorage::CreateFindIterator(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string mask = "*";
+  if (info.Length() > 0 && info[0].IsString()) {
+    mask = info[0].As<Napi::String>().Utf8Value();
+  }
+
+  size_t batchSize = 4096;
+  if (info.Length() > 1 && info[1].IsNumber() && info[1].As<Napi::Number>().Uint32Value() > 0) {
+    batchSize = info[1].As<Napi::Number>().Uint32Value();
+  }
+
+  std::string listFileStr;
+  const char* listFile = nullptr;
+  if (info.Length() > 2 && info[2].IsString()) {
+    listFileStr = info[2].As<Napi::String>().Utf8Value();
+    listFile = listFileStr.c_str();
+  }
+
+  // The iterator owns this handle; the storage's own search is left alone
+  CASC_FIND_DATA findData = {0};
+  HANDLE hIteratorFind = CascFindFirstFileLocked(*rootLock, stats.get(), hStorage, mask.c_str(), &findData, listFile);
+
+  if (!hIteratorFind || hIteratorFind == INVALID_HANDLE_VALUE) {
+    return CascFindIterator::NewInstance(env, nullptr, nullptr, batchSize, stats, rootLock, false);
+  }
+
+  return CascFindIterator::NewInstance(env, hIteratorFind, &findData, batchSize, stats, rootLock, listFile != nullptr);
+}
+
+// Throws if buildNameIndex has not finished yet
+const CascNameIndex* CascStorage::GetNameIndex(Napi::Env env) {
+  if (!nameIndex) {
+    Napi::Error::New(env, "Name index is not built; call buildNameIndex() first")
+      .ThrowAsJavaScriptException();
+  }
+  return nameIndex.get();
+}
+
+static Napi::Array ToStringArray(Napi::Env env, const std::vector<std::string>& strings) {
+  Napi::Array array = Napi::Array::New(env, strings.size());
+  for (size_t i = 0; i < strings.size(); i++) {
+    array.Set(static_cast<uint32_t>(i), Napi::String::New(env, strings[i]));
+  }
+  return array;
+}
+
+Napi::Value CascStorage::BuildNameIndex(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (nameIndex) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(Napi::Number::New(env, static_cast<double>(nameIndex->Count())));
+    return deferred.Promise();
+  }
+
+  BuildNameIndexWorker* worker = new BuildNameIndexWorker(env, this);
+  Napi::Promise promise = worker->GetPromise();
+  worker->Queue();
+  return promise;
+}
+
+Napi::Value CascStorage::FindPrefix(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected prefix string as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const CascNameIndex* index = GetNameIndex(env);
+  if (index == nullptr) {
+    return env.Null();
+  }
+
+  std::vector<std::string> matches;
+  index->FindPrefix(info[0].As<Napi::String>().Utf8Value(), matches);
+  return ToStringArray(env, matches);
+}
+
+Napi::Value CascStorage::ListDirectory(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hStorage) {
+    Napi::Error::New(env, "Storage is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const CascNameIndex* index = GetNameIndex(env);
+  if (index == nullptr) {
+    return env.Null();
+  }
+
+  std::string path;
+  if (info.Length() > 0 && info[0].IsString()) {
+    path = info[0].As<Napi::String>().Utf8Value();
+  }
+
+  std::vector<std::string> directories;
+  std::vector<std::string> files;
+  index->ListDirectory(path, directories, files);
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("directories", ToStringArray(env, directories));
+  result.Set("files", ToStringArray(env, files));
+  return result;
+}
+
 Napi::Value CascStorage::AddEncryptionKey(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
@@ -2,7 +2,11 @@
 #define CASCLIB_STORAGE_H
 
 #include <napi.h>
+#include <memory>
 #include "CascLib.h"
+#include "lookup.h"
+#include "nameindex.h"
+#include "stats.h"
 
 class CascStorage : public Napi::ObjectWrap<CascStorage> {
 public:
@@ -17,16 +21,30 @@ private:
   Napi::Value Open(const Napi::CallbackInfo& info);
   Napi::Value OpenOnline(const Napi::CallbackInfo& info);
   Napi::Value OpenEx(const Napi::CallbackInfo& info);
+  Napi::Value OpenAsync(const Napi::CallbackInfo& info);
   Napi::Value Close(const Napi::CallbackInfo& info);
   Napi::Value OpenFile(const Napi::CallbackInfo& info);
   Napi::Value GetFileInfo(const Napi::CallbackInfo& info);
   Napi::Value FileExists(const Napi::CallbackInfo& info);
+  Napi::Value ExistsMany(const Napi::CallbackInfo& info);
+  Napi::Value StatMany(const Napi::CallbackInfo& info);
   Napi::Value GetStorageInfo(const Napi::CallbackInfo& info);
+  Napi::Value ReadFiles(const Napi::CallbackInfo& info);
+  Napi::Value VerifyAll(const Napi::CallbackInfo& info);
+  Napi::Value Extract(const Napi::CallbackInfo& info);
+  Napi::Value MatchNameHashes(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+  Napi::Value ResetStats(const Napi::CallbackInfo& info);
   
   // Find methods
   Napi::Value FindFirstFile(const Napi::CallbackInfo& info);
   Napi::Value FindNextFile(const Napi::CallbackInfo& info);
   Napi::Value FindClose(const Napi::CallbackInfo& info);
+  Napi::Value FindBatch(const Napi::CallbackInfo& info);
+  Napi::Value CreateFindIterator(const Napi::CallbackInfo& info);
+  Napi::Value BuildNameIndex(const Napi::CallbackInfo& info);
+  Napi::Value FindPrefix(const Napi::CallbackInfo& info);
+  Napi::Value ListDirectory(const Napi::CallbackInfo& info);
   
   // Encryption key methods
   Napi::Value AddEncryptionKey(const Napi::CallbackInfo& info);
@@ -36,11 +54,33 @@ private:
   Napi::Value FindEncryptionKey(const Napi::CallbackInfo& info);
   Napi::Value GetNotFoundEncryptionKey(const Napi::CallbackInfo& info);
 
+  bool FileExistsByRef(const void* pvFileName, DWORD dwOpenFlags);
+  const CascNameIndex* GetNameIndex(Napi::Env env);
+
+  // Async workers use the storage handle from pool threads
+  friend class ReadFilesWorker;
+  friend class OpenStorageWorker;
+  friend class VerifyWorker;
+  friend class ExtractWorker;
+  friend class MatchNameHashesWorker;
+  friend class BuildNameIndexWorker;
+
   // Member variables
   HANDLE hStorage;
   HANDLE hFind;
   bool isOpen;
   bool isFindOpen;
+  bool findHasListFile;
+  int pendingOps;
+
+  // Sorted names for prefix and directory queries; built by buildNameIndex, dropped on close
+  std::unique_ptr<CascNameIndex> nameIndex;
+
+  // Shared with files and iterators opened from this storage
+  std::shared_ptr<CascStats> stats;
+
+  // Held by every search and name lookup on this storage; iterators keep their own reference
+  std::shared_ptr<CascRootLock> rootLock;
 };
 
 #endif // CASCLIB_STORAGE_H
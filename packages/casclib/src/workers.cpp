@@ -0,0 +1,1046 @@
+#include "workers.h"
+#include "storage.h"
+#include "parallel.h"
+#include "CascCommon.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#endif
+
+// Reads the whole file into a malloc'd block owned by the caller
+static bool ReadWholeFile(HANDLE hFile, uint8_t** data, DWORD* size, CascStats* stats) {
+  DWORD fileSize = CascGetFileSize(hFile, nullptr);
+  if (fileSize == CASC_INVALID_SIZE) {
+    return false;
+  }
+
+  uint8_t* buffer = static_cast<uint8_t*>(malloc(fileSize ? fileSize : 1));
+  if (buffer == nullptr) {
+    SetCascError(ERROR_NOT_ENOUGH_MEMORY);
+    return false;
+  }
+
+  DWORD bytesRead = 0;
+  if (fileSize > 0 && !CascReadFileTimed(stats, hFile, buffer, fileSize, &bytesRead)) {
+    free(buffer);
+    return false;
+  }
+
+  *data = buffer;
+  *size = bytesRead;
+  return true;
+}
+
+// Wraps a malloc'd block in a Buffer without copying it
+static Napi::Buffer<uint8_t> TakeBuffer(Napi::Env env, uint8_t* data, size_t size) {
+  return Napi::Buffer<uint8_t>::NewOrCopy(env, data, size,
+    [](Napi::Env /*env*/, uint8_t* finalizeData) { free(finalizeData); });
+}
+
+bool ReadFilesWindow::Acquire() {
+  std::unique_lock<std::mutex> guard(lock);
+  ready.wait(guard, [this] { return closed || limit == 0 || held < limit; });
+  if (closed) {
+    return false;
+  }
+  held++;
+  return true;
+}
+
+void ReadFilesWindow::Release(size_t count) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    held -= std::min(count, held);
+  }
+  ready.notify_all();
+}
+
+void ReadFilesWindow::Close() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    closed = true;
+  }
+  ready.notify_all();
+}
+
+ReadFilesWorker::ReadFilesWorker(Napi::Env env, CascStorage* storage, CascFileRefs&& files,
+                                 DWORD openFlags, size_t concurrency, size_t window, Napi::Function onFile)
+  : Napi::AsyncProgressQueueWorker<ReadFilesItem>(env, "CascReadFiles"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    onFile(Napi::Persistent(onFile)),
+    storage(storage), hStorage(storage->hStorage), files(std::move(files)),
+    openFlags(openFlags), concurrency(concurrency),
+    window(std::make_shared<ReadFilesWindow>()), aborted(false), delivered(0) {
+  this->window->limit = window;
+
+  // The window is shared with the function, which may outlive the worker
+  std::shared_ptr<ReadFilesWindow> slots = this->window;
+  release = Napi::Persistent(Napi::Function::New(env, [slots](const Napi::CallbackInfo& info) {
+    size_t count = 1;
+    if (info.Length() > 0 && info[0].IsNumber()) {
+      count = info[0].As<Napi::Number>().Uint32Value();
+    }
+    slots->Release(count);
+  }, "release"));
+
+  storage->pendingOps++;
+}
+
+Napi::Promise ReadFilesWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+void ReadFilesWorker::Execute(const ExecutionProgress& progress) {
+  CascStats* stats = storage->stats.get();
+
+  ParallelFor(concurrency, files.Count(), aborted, [&](size_t /*workerIndex*/, size_t itemIndex) {
+    ReadFilesItem item = { (uint32_t)itemIndex, nullptr, 0, ERROR_SUCCESS };
+    HANDLE hFile = nullptr;
+
+    // Waits while the consumer is behind by a full window
+    if (!window->Acquire()) {
+      aborted = true;
+      return;
+    }
+
+    // Every read uses its own handle, so pool threads never share file state
+    if (CascOpenFileTimed(stats, hStorage, files.Get(itemIndex), CASC_LOCALE_ALL, openFlags, &hFile)) {
+      item.cached = CascReadFileCached(hFile, stats);
+      if (!item.cached && !ReadWholeFile(hFile, &item.data, &item.size, stats)) {
+        item.error = CascReadError(hStorage, files.Get(itemIndex), openFlags);
+      }
+      CascCloseFileCounted(stats, hFile);
+    } else {
+      item.error = CascOpenError(hStorage, files.Get(itemIndex), openFlags);
+    }
+
+    progress.Send(&item, 1);
+  });
+}
+
+void ReadFilesWorker::OnProgress(const ReadFilesItem* items, size_t count) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  for (size_t i = 0; i < count; i++) {
+    const ReadFilesItem& item = items[i];
+
+    // Results still in flight after an abort are dropped
+    if (aborted) {
+      free(item.data);
+      continue;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("index", Napi::Number::New(env, item.index));
+    result.Set("name", Napi::String::New(env, files.Describe(item.index)));
+    if (item.cached) {
+      result.Set("data", ContentBlockBuffer(env, item.cached));
+    } else if (item.data != nullptr) {
+      result.Set("data", TakeBuffer(env, item.data, item.size));
+    } else {
+      result.Set("data", env.Null());
+      result.Set("error", Napi::Number::New(env, item.error));
+    }
+
+    Napi::Value ret = onFile.Call({ result, release.Value() });
+    delivered++;
+
+    if (env.IsExceptionPending()) {
+      callbackError = Napi::Persistent(env.GetAndClearPendingException().Value());
+      aborted = true;
+    } else if (ret.IsBoolean() && !ret.As<Napi::Boolean>().Value()) {
+      // Returning false from the callback stops the remaining reads
+      aborted = true;
+    }
+
+    // Threads waiting for a slot must not wait for results that never come
+    if (aborted) {
+      window->Close();
+    }
+  }
+}
+
+void ReadFilesWorker::OnOK() {
+  storage->pendingOps--;
+
+  if (!callbackError.IsEmpty()) {
+    deferred.Reject(callbackError.Value());
+    return;
+  }
+
+  deferred.Resolve(Napi::Number::New(Env(), delivered));
+}
+
+void ReadFilesWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+  deferred.Reject(e.Value());
+}
+
+void OpenStorageParams::FillArgs(CASC_OPEN_STORAGE_ARGS& args) const {
+  args.Size = sizeof(CASC_OPEN_STORAGE_ARGS);
+  args.dwLocaleMask = localeMask;
+  args.dwFlags = flags;
+  args.szCodeName = codeName.empty() ? nullptr : codeName.c_str();
+  args.szRegion = region.empty() ? nullptr : region.c_str();
+  args.szBuildKey = buildKey.empty() ? nullptr : buildKey.c_str();
+  args.szCdnHostUrl = cdnHostUrl.empty() ? nullptr : cdnHostUrl.c_str();
+}
+
+OpenStorageWorker::OpenStorageWorker(Napi::Env env, CascStorage* storage, OpenStorageParams&& params,
+                                     Napi::Function onProgress)
+  : Napi::AsyncProgressQueueWorker<OpenStorageProgress>(env, "CascOpenStorage"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    storage(storage), params(std::move(params)),
+    executionProgress(nullptr), aborted(false), hStorage(nullptr), openMicros(0) {
+  if (!onProgress.IsEmpty()) {
+    this->onProgress = Napi::Persistent(onProgress);
+  }
+  storage->pendingOps++;
+}
+
+Napi::Promise OpenStorageWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+bool WINAPI OpenStorageWorker::ProgressCallback(void* param, CASC_PROGRESS_MSG message, LPCSTR szObject,
+                                                DWORD current, DWORD total) {
+  OpenStorageWorker* worker = static_cast<OpenStorageWorker*>(param);
+
+  if (!worker->onProgress.IsEmpty()) {
+    OpenStorageProgress item = { message, szObject ? szObject : "", current, total };
+    worker->executionProgress->Send(&item, 1);
+  }
+
+  // Returning true tells CascLib to stop loading
+  return worker->aborted.load();
+}
+
+void OpenStorageWorker::Execute(const ExecutionProgress& progress) {
+  CASC_OPEN_STORAGE_ARGS args = {0};
+  params.FillArgs(args);
+  args.PfnProgressCallback = ProgressCallback;
+  args.PtrProgressParam = this;
+  executionProgress = &progress;
+
+  CascStopwatch stopwatch;
+  if (!CascOpenStorageEx(params.params.c_str(), &args, params.online, &hStorage)) {
+    hStorage = nullptr;
+    SetError(aborted ? "CASC storage open was cancelled"
+                     : "Failed to open CASC storage with extended parameters: " + params.params);
+    return;
+  }
+
+  // Cancelled after the last progress message; do not hand out the storage
+  if (aborted) {
+    CascCloseStorage(hStorage);
+    hStorage = nullptr;
+    SetError("CASC storage open was cancelled");
+    return;
+  }
+
+  openMicros = stopwatch.Micros();
+}
+
+void OpenStorageWorker::OnProgress(const OpenStorageProgress* items, size_t count) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  for (size_t i = 0; i < count && !aborted; i++) {
+    const OpenStorageProgress& item = items[i];
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("message", Napi::Number::New(env, item.message));
+    result.Set("object", item.object.empty() ? env.Null() : Napi::String::New(env, item.object));
+    result.Set("current", Napi::Number::New(env, item.current));
+    result.Set("total", Napi::Number::New(env, item.total));
+
+    Napi::Value ret = onProgress.Call({ result });
+
+    if (env.IsExceptionPending()) {
+      callbackError = Napi::Persistent(env.GetAndClearPendingException().Value());
+      aborted = true;
+    } else if (ret.IsBoolean() && !ret.As<Napi::Boolean>().Value()) {
+      // Returning false from the callback cancels the open
+      aborted = true;
+    }
+  }
+}
+
+void OpenStorageWorker::OnOK() {
+  storage->pendingOps--;
+  storage->hStorage = hStorage;
+  storage->isOpen = true;
+  storage->stats->storageOpens++;
+  storage->stats->storageOpenTime.Record(openMicros);
+  deferred.Resolve(Napi::Boolean::New(Env(), true));
+}
+
+void OpenStorageWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+
+  if (!callbackError.IsEmpty()) {
+    deferred.Reject(callbackError.Value());
+    return;
+  }
+
+  deferred.Reject(e.Value());
+}
+
+// Size of the per-thread buffer used to stream file content
+static const size_t kStreamBufferSize = 0x100000;
+
+// Elapsed time and progress rate limiting shared by pool threads
+class ProgressClock {
+public:
+  ProgressClock() : startTime(Clock::now()), lastReport(0) {}
+
+  // True at most once per 100 ms across all threads
+  bool ShouldReport() {
+    static const int64_t interval = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(100)).count();
+    int64_t now = (Clock::now() - startTime).count();
+    int64_t last = lastReport.load();
+    return now - last >= interval && lastReport.compare_exchange_strong(last, now);
+  }
+
+  double Seconds() const {
+    return std::chrono::duration<double>(Clock::now() - startTime).count();
+  }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point startTime;
+  std::atomic<int64_t> lastReport;
+};
+
+// Calls fn for every file matching the mask until the search ends or abort is set
+template <typename Fn>
+static void ForEachFindData(HANDLE hStorage, CascStats* stats, CascRootLock& rootLock, const std::string& mask,
+                            const std::string& listFile, const std::atomic<bool>& abort, Fn fn) {
+  CASC_FIND_DATA findData;
+  HANDLE hFind = CascFindFirstFileLocked(rootLock, stats, hStorage, mask.c_str(), &findData,
+                                         listFile.empty() ? nullptr : listFile.c_str());
+
+  if (hFind == nullptr) {
+    return;
+  }
+
+  do {
+    fn(findData);
+  } while (!abort && CascFindNextFileLocked(rootLock, !listFile.empty(), stats, hFind, &findData));
+
+  CascFindClose(hFind);
+}
+
+VerifyWorker::VerifyWorker(Napi::Env env, CascStorage* storage, std::string&& mask, std::string&& listFile,
+                           size_t threads, Napi::Function onProgress)
+  : Napi::AsyncProgressQueueWorker<VerifyProgress>(env, "CascVerifyAll"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    storage(storage), hStorage(storage->hStorage), mask(std::move(mask)), listFile(std::move(listFile)),
+    threads(threads), aborted(false), filesChecked(0), bytesChecked(0), seconds(0) {
+  if (!onProgress.IsEmpty()) {
+    this->onProgress = Napi::Persistent(onProgress);
+  }
+  storage->pendingOps++;
+}
+
+Napi::Promise VerifyWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+VerifyStatus VerifyWorker::VerifyEntry(Entry& entry, std::vector<uint8_t>& buffer, uint64_t& bytesRead) {
+  HANDLE hFile = nullptr;
+  MD5_CTX md5;
+  BYTE digest[MD5_HASH_SIZE];
+  DWORD chunkRead = 0;
+
+  // Strict checking also validates the hash of every encoded frame.
+  // Entries not flagged available are still tried, since online storages
+  // fetch them on demand.
+  CascStats* stats = storage->stats.get();
+  const DWORD openFlags = CASC_OPEN_BY_CKEY | CASC_STRICT_DATA_CHECK;
+  if (!CascOpenFileTimed(stats, hStorage, entry.ckey, CASC_LOCALE_ALL, openFlags, &hFile)) {
+    entry.error = CascOpenError(hStorage, entry.ckey, openFlags);
+    return (entry.error == ERROR_FILE_NOT_FOUND || !entry.available) ? VerifyMissing : VerifyFailed;
+  }
+
+  MD5_Init(&md5);
+  for (;;) {
+    if (!CascReadFileTimed(stats, hFile, buffer.data(), (DWORD)buffer.size(), &chunkRead)) {
+      entry.error = ERROR_FILE_CORRUPT;
+      break;
+    }
+    if (chunkRead == 0) {
+      break;
+    }
+    MD5_Update(&md5, buffer.data(), chunkRead);
+    bytesRead += chunkRead;
+  }
+  MD5_Final(digest, &md5);
+  CascCloseFileCounted(stats, hFile);
+
+  // The handle is closed before the failure is looked into, which reads the file again
+  if (entry.error != ERROR_SUCCESS) {
+    entry.error = CascReadError(hStorage, entry.ckey, openFlags);
+  }
+
+  switch (entry.error) {
+    case ERROR_SUCCESS:
+      return (memcmp(digest, entry.ckey, MD5_HASH_SIZE) == 0) ? VerifyOk : VerifyMismatch;
+    case ERROR_FILE_ENCRYPTED:
+      return VerifyEncrypted;
+    case ERROR_FILE_CORRUPT:
+      return entry.available ? VerifyMismatch : VerifyMissing;
+    default:
+      return entry.available ? VerifyFailed : VerifyMissing;
+  }
+}
+
+void VerifyWorker::Execute(const ExecutionProgress& progress) {
+  ProgressClock clock;
+
+  // Names that share a CKey are verified once
+  std::unordered_set<std::string> seenKeys;
+  ForEachFindData(hStorage, storage->stats.get(), *storage->rootLock, mask, listFile, aborted, [&](const CASC_FIND_DATA& findData) {
+    if (!seenKeys.insert(std::string(reinterpret_cast<const char*>(findData.CKey), MD5_HASH_SIZE)).second) {
+      return;
+    }
+
+    Entry entry;
+    entry.name = findData.szFileName;
+    memcpy(entry.ckey, findData.CKey, MD5_HASH_SIZE);
+    entry.available = findData.bFileAvailable ? true : false;
+    entry.status = VerifyPending;
+    entry.error = ERROR_SUCCESS;
+    entries.push_back(std::move(entry));
+  });
+
+  // One read buffer per worker thread
+  std::vector<std::vector<uint8_t>> buffers(std::max<size_t>(1, std::min(threads, entries.size())));
+
+  ParallelFor(threads, entries.size(), aborted, [&](size_t workerIndex, size_t itemIndex) {
+    std::vector<uint8_t>& buffer = buffers[workerIndex];
+    if (buffer.empty()) {
+      buffer.resize(kStreamBufferSize);
+    }
+
+    uint64_t bytesRead = 0;
+    Entry& entry = entries[itemIndex];
+    entry.status = VerifyEntry(entry, buffer, bytesRead);
+
+    uint32_t checked = ++filesChecked;
+    uint64_t bytes = (bytesChecked += bytesRead);
+
+    if (!onProgress.IsEmpty() && (clock.ShouldReport() || checked == entries.size())) {
+      VerifyProgress item = { checked, (uint32_t)entries.size(), bytes };
+      progress.Send(&item, 1);
+    }
+  });
+
+  seconds = clock.Seconds();
+}
+
+void VerifyWorker::OnProgress(const VerifyProgress* items, size_t count) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  // Only the most recent update in a batch is interesting
+  if (count == 0 || aborted) {
+    return;
+  }
+
+  const VerifyProgress& item = items[count - 1];
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("filesChecked", Napi::Number::New(env, item.filesChecked));
+  result.Set("filesTotal", Napi::Number::New(env, item.filesTotal));
+  result.Set("bytesChecked", Napi::Number::New(env, (double)item.bytesChecked));
+
+  Napi::Value ret = onProgress.Call({ result });
+
+  if (env.IsExceptionPending()) {
+    callbackError = Napi::Persistent(env.GetAndClearPendingException().Value());
+    aborted = true;
+  } else if (ret.IsBoolean() && !ret.As<Napi::Boolean>().Value()) {
+    // Returning false from the callback stops the verification
+    aborted = true;
+  }
+}
+
+void VerifyWorker::OnOK() {
+  Napi::Env env = Env();
+  storage->pendingOps--;
+
+  if (!callbackError.IsEmpty()) {
+    deferred.Reject(callbackError.Value());
+    return;
+  }
+
+  Napi::Array mismatched = Napi::Array::New(env);
+  Napi::Array missing = Napi::Array::New(env);
+  Napi::Array encrypted = Napi::Array::New(env);
+  Napi::Array failed = Napi::Array::New(env);
+  uint32_t ok = 0;
+  uint32_t checked = filesChecked;
+
+  // Entries not reached after an abort stay pending
+  for (const Entry& entry : entries) {
+    switch (entry.status) {
+      case VerifyPending:
+        break;
+      case VerifyOk:
+        ok++;
+        break;
+      case VerifyMismatch:
+        mismatched.Set(mismatched.Length(), Napi::String::New(env, entry.name));
+        break;
+      case VerifyMissing:
+        missing.Set(missing.Length(), Napi::String::New(env, entry.name));
+        break;
+      case VerifyEncrypted:
+        encrypted.Set(encrypted.Length(), Napi::String::New(env, entry.name));
+        break;
+      case VerifyFailed: {
+        Napi::Object failure = Napi::Object::New(env);
+        failure.Set("name", Napi::String::New(env, entry.name));
+        failure.Set("error", Napi::Number::New(env, entry.error));
+        failed.Set(failed.Length(), failure);
+        break;
+      }
+    }
+  }
+
+  double bytes = (double)bytesChecked.load();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("filesTotal", Napi::Number::New(env, (double)entries.size()));
+  result.Set("filesChecked", Napi::Number::New(env, checked));
+  result.Set("ok", Napi::Number::New(env, ok));
+  result.Set("mismatched", mismatched);
+  result.Set("missing", missing);
+  result.Set("encrypted", encrypted);
+  result.Set("failed", failed);
+  result.Set("bytesChecked", Napi::Number::New(env, bytes));
+  result.Set("seconds", Napi::Number::New(env, seconds));
+  result.Set("filesPerSecond", Napi::Number::New(env, seconds > 0 ? checked / seconds : 0));
+  result.Set("bytesPerSecond", Napi::Number::New(env, seconds > 0 ? bytes / seconds : 0));
+  result.Set("aborted", Napi::Boolean::New(env, aborted.load()));
+  deferred.Resolve(result);
+}
+
+void VerifyWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+  deferred.Reject(e.Value());
+}
+
+// Maps a storage file name to a path below outDir. Names that would leave
+// it (".." components, drive letters) are rejected.
+static bool GetOutputPath(const std::filesystem::path& outDir, const std::string& name, std::filesystem::path& path) {
+  std::filesystem::path relative;
+  size_t start = 0;
+
+  while (start <= name.size()) {
+    size_t end = name.find_first_of("/\\", start);
+    if (end == std::string::npos) {
+      end = name.size();
+    }
+
+    std::string part = name.substr(start, end - start);
+    if (part == "..") {
+      return false;
+    }
+#ifdef _WIN32
+    if (part.find(':') != std::string::npos) {
+      return false;
+    }
+#endif
+    if (!part.empty() && part != ".") {
+      relative /= std::filesystem::u8path(part);
+    }
+
+    start = end + 1;
+  }
+
+  if (relative.empty()) {
+    return false;
+  }
+
+  path = outDir / relative;
+  return true;
+}
+
+static FILE* OpenOutputFile(const std::filesystem::path& path, bool write) {
+#ifdef _WIN32
+  return _wfopen(path.c_str(), write ? L"wb" : L"rb");
+#else
+  return fopen(path.c_str(), write ? "wb" : "rb");
+#endif
+}
+
+// Reserves disk space up front so large files are not fragmented
+static void PreallocateFile(FILE* fp, ULONGLONG size) {
+#if defined(_WIN32)
+  _chsize_s(_fileno(fp), (__int64)size);
+#elif defined(__linux__)
+  posix_fallocate(fileno(fp), 0, (off_t)size);
+#else
+  (void)fp;
+  (void)size;
+#endif
+}
+
+// True if the file exists with the given size and its MD5 equals ckey
+static bool OutputMatches(const std::filesystem::path& path, ULONGLONG size, const BYTE* ckey,
+                          std::vector<uint8_t>& buffer) {
+  std::error_code ec;
+  if (std::filesystem::file_size(path, ec) != size || ec) {
+    return false;
+  }
+
+  FILE* fp = OpenOutputFile(path, false);
+  if (fp == nullptr) {
+    return false;
+  }
+
+  MD5_CTX md5;
+  BYTE digest[MD5_HASH_SIZE];
+  size_t chunkRead;
+
+  MD5_Init(&md5);
+  while ((chunkRead = fread(buffer.data(), 1, buffer.size(), fp)) > 0) {
+    MD5_Update(&md5, buffer.data(), (unsigned long)chunkRead);
+  }
+  MD5_Final(digest, &md5);
+
+  bool readError = ferror(fp) != 0;
+  fclose(fp);
+  return !readError && memcmp(digest, ckey, MD5_HASH_SIZE) == 0;
+}
+
+ExtractWorker::ExtractWorker(Napi::Env env, CascStorage* storage, std::string&& mask, std::string&& outDir,
+                             std::string&& listFile, size_t threads, Napi::Function onProgress)
+  : Napi::AsyncProgressQueueWorker<ExtractProgress>(env, "CascExtract"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    storage(storage), hStorage(storage->hStorage), mask(std::move(mask)), outDir(std::move(outDir)),
+    listFile(std::move(listFile)), threads(threads), aborted(false), filesDone(0), bytesWritten(0), seconds(0) {
+  if (!onProgress.IsEmpty()) {
+    this->onProgress = Napi::Persistent(onProgress);
+  }
+  storage->pendingOps++;
+}
+
+Napi::Promise ExtractWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+ExtractWorker::Status ExtractWorker::ExtractEntry(Entry& entry, std::vector<uint8_t>& buffer, uint64_t& bytesOut) {
+  std::filesystem::path path;
+  std::error_code ec;
+  HANDLE hFile = nullptr;
+  DWORD chunkRead = 0;
+
+  if (!GetOutputPath(std::filesystem::u8path(outDir), entry.name, path)) {
+    entry.error = ERROR_INVALID_PARAMETER;
+    return ExtractFailed;
+  }
+
+  if (entry.size != CASC_INVALID_SIZE64 && OutputMatches(path, entry.size, entry.ckey, buffer)) {
+    return ExtractSkipped;
+  }
+
+  CascStats* stats = storage->stats.get();
+  if (!CascOpenFileTimed(stats, hStorage, entry.ckey, CASC_LOCALE_ALL, CASC_OPEN_BY_CKEY, &hFile)) {
+    entry.error = CascOpenError(hStorage, entry.ckey, CASC_OPEN_BY_CKEY);
+    return ExtractFailed;
+  }
+
+  std::filesystem::create_directories(path.parent_path(), ec);
+  FILE* fp = ec ? nullptr : OpenOutputFile(path, true);
+  if (fp == nullptr) {
+    CascCloseFileCounted(stats, hFile);
+    entry.error = ERROR_CAN_NOT_COMPLETE;
+    return ExtractFailed;
+  }
+
+  if (entry.size != CASC_INVALID_SIZE64) {
+    PreallocateFile(fp, entry.size);
+  }
+
+  bool complete = false;
+  bool readFailed = false;
+  uint64_t written = 0;
+  while (!aborted) {
+    if (!CascReadFileTimed(stats, hFile, buffer.data(), (DWORD)buffer.size(), &chunkRead)) {
+      readFailed = true;
+      break;
+    }
+    if (chunkRead == 0) {
+      complete = true;
+      break;
+    }
+    if (fwrite(buffer.data(), 1, chunkRead, fp) != chunkRead) {
+      entry.error = ERROR_CAN_NOT_COMPLETE;
+      break;
+    }
+    written += chunkRead;
+  }
+
+  CascCloseFileCounted(stats, hFile);
+  if (readFailed) {
+    entry.error = CascReadError(hStorage, entry.ckey, CASC_OPEN_BY_CKEY);
+  }
+  if (fclose(fp) != 0 && entry.error == ERROR_SUCCESS) {
+    entry.error = ERROR_CAN_NOT_COMPLETE;
+  }
+
+  // The file was preallocated to the listed size; drop whatever the
+  // decoded content did not fill
+  if (complete && entry.error == ERROR_SUCCESS && entry.size != CASC_INVALID_SIZE64 && written != entry.size) {
+    std::filesystem::resize_file(path, written, ec);
+    if (ec) {
+      entry.error = ERROR_CAN_NOT_COMPLETE;
+    }
+  }
+  bytesOut += written;
+
+  // Never leave a truncated file behind; it would only look extracted
+  if (entry.error != ERROR_SUCCESS || !complete) {
+    std::filesystem::remove(path, ec);
+    return (entry.error == ERROR_SUCCESS) ? ExtractPending : ExtractFailed;
+  }
+
+  return ExtractWritten;
+}
+
+void ExtractWorker::Execute(const ExecutionProgress& progress) {
+  ProgressClock clock;
+
+  // Storages list a name once per locale, and names that differ only in
+  // case or slashes land in the same output file. Only the first is
+  // extracted, so no two threads ever write the same path.
+  std::unordered_set<std::string> seenNames;
+  ForEachFindData(hStorage, storage->stats.get(), *storage->rootLock, mask, listFile, aborted, [&](const CASC_FIND_DATA& findData) {
+    if (!seenNames.insert(CascNameIndex::Normalize(findData.szFileName)).second) {
+      return;
+    }
+
+    Entry entry;
+    entry.name = findData.szFileName;
+    memcpy(entry.ckey, findData.CKey, MD5_HASH_SIZE);
+    entry.size = findData.FileSize;
+    entry.status = ExtractPending;
+    entry.error = ERROR_SUCCESS;
+    entries.push_back(std::move(entry));
+  });
+
+  // One read buffer per worker thread
+  std::vector<std::vector<uint8_t>> buffers(std::max<size_t>(1, std::min(threads, entries.size())));
+
+  ParallelFor(threads, entries.size(), aborted, [&](size_t workerIndex, size_t itemIndex) {
+    std::vector<uint8_t>& buffer = buffers[workerIndex];
+    if (buffer.empty()) {
+      buffer.resize(kStreamBufferSize);
+    }
+
+    uint64_t bytesOut = 0;
+    Entry& entry = entries[itemIndex];
+    entry.status = ExtractEntry(entry, buffer, bytesOut);
+    if (entry.status == ExtractPending) {
+      return;
+    }
+
+    uint32_t done = ++filesDone;
+    uint64_t bytes = (bytesWritten += bytesOut);
+
+    if (!onProgress.IsEmpty() && (clock.ShouldReport() || done == entries.size())) {
+      ExtractProgress item = { done, (uint32_t)entries.size(), bytes };
+      progress.Send(&item, 1);
+    }
+  });
+
+  seconds = clock.Seconds();
+}
+
+void ExtractWorker::OnProgress(const ExtractProgress* items, size_t count) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  // Only the most recent update in a batch is interesting
+  if (count == 0 || aborted) {
+    return;
+  }
+
+  const ExtractProgress& item = items[count - 1];
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("filesDone", Napi::Number::New(env, item.filesDone));
+  result.Set("filesTotal", Napi::Number::New(env, item.filesTotal));
+  result.Set("bytesWritten", Napi::Number::New(env, (double)item.bytesWritten));
+
+  Napi::Value ret = onProgress.Call({ result });
+
+  if (env.IsExceptionPending()) {
+    callbackError = Napi::Persistent(env.GetAndClearPendingException().Value());
+    aborted = true;
+  } else if (ret.IsBoolean() && !ret.As<Napi::Boolean>().Value()) {
+    // Returning false from the callback stops the extraction
+    aborted = true;
+  }
+}
+
+void ExtractWorker::OnOK() {
+  Napi::Env env = Env();
+  storage->pendingOps--;
+
+  if (!callbackError.IsEmpty()) {
+    deferred.Reject(callbackError.Value());
+    return;
+  }
+
+  Napi::Array failed = Napi::Array::New(env);
+  uint32_t written = 0;
+  uint32_t skipped = 0;
+
+  for (const Entry& entry : entries) {
+    switch (entry.status) {
+      case ExtractPending:
+        break;
+      case ExtractWritten:
+        written++;
+        break;
+      case ExtractSkipped:
+        skipped++;
+        break;
+      case ExtractFailed: {
+        Napi::Object failure = Napi::Object::New(env);
+        failure.Set("name", Napi::String::New(env, entry.name));
+        failure.Set("error", Napi::Number::New(env, entry.error));
+        failed.Set(failed.Length(), failure);
+        break;
+      }
+    }
+  }
+
+  uint32_t done = filesDone;
+  double bytes = (double)bytesWritten.load();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("filesTotal", Napi::Number::New(env, (double)entries.size()));
+  result.Set("filesWritten", Napi::Number::New(env, written));
+  result.Set("filesSkipped", Napi::Number::New(env, skipped));
+  result.Set("failed", failed);
+  result.Set("bytesWritten", Napi::Number::New(env, bytes));
+  result.Set("seconds", Napi::Number::New(env, seconds));
+  result.Set("filesPerSecond", Napi::Number::New(env, seconds > 0 ? done / seconds : 0));
+  result.Set("bytesPerSecond", Napi::Number::New(env, seconds > 0 ? bytes / seconds : 0));
+  result.Set("aborted", Napi::Boolean::New(env, aborted.load()));
+  deferred.Resolve(result);
+}
+
+void ExtractWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+  deferred.Reject(e.Value());
+}
+
+// Candidate names from listfile content: one per line, blank lines skipped,
+// and the FileDataId column of "id;name" lines dropped
+static void SplitListFile(const std::string& content, std::vector<std::string>& names) {
+  size_t start = 0;
+
+  while (start < content.size()) {
+    size_t end = content.find('\n', start);
+    if (end == std::string::npos) {
+      end = content.size();
+    }
+
+    size_t nameStart = start;
+    size_t nameEnd = end;
+    if (nameEnd > nameStart && content[nameEnd - 1] == '\r') {
+      nameEnd--;
+    }
+
+    size_t separator = std::find(content.begin() + nameStart, content.begin() + nameEnd, ';') - content.begin();
+    if (separator < nameEnd && separator > nameStart &&
+        std::all_of(content.begin() + nameStart, content.begin() + separator, [](char ch) { return ch >= '0' && ch <= '9'; })) {
+      nameStart = separator + 1;
+    }
+
+    if (nameEnd > nameStart) {
+      names.emplace_back(content, nameStart, nameEnd - nameStart);
+    }
+    start = end + 1;
+  }
+}
+
+MatchNameHashesWorker::MatchNameHashesWorker(Napi::Env env, CascStorage* storage, HANDLE hStorage,
+                                             std::vector<std::string>&& names, std::string&& listFile, size_t threads)
+  : Napi::AsyncWorker(env, "CascMatchNameHashes"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    storage(storage), hStorage(hStorage), names(std::move(names)), listFile(std::move(listFile)),
+    threads(threads), seconds(0) {
+  storage->pendingOps++;
+}
+
+Napi::Promise MatchNameHashesWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+void MatchNameHashesWorker::Execute() {
+  CascStopwatch stopwatch;
+
+  if (!listFile.empty()) {
+    SplitListFile(listFile, names);
+    std::string().swap(listFile);
+  }
+
+  std::atomic<bool> aborted(false);
+  found.assign(names.size(), 0);
+  // Lookups are cheap, so names are handed out in runs and the root lock is
+  // taken once per run rather than once per name
+  ParallelForChunks(threads, names.size(), 4096, aborted, [&](size_t, size_t begin, size_t end) {
+    std::shared_lock<CascRootLock> guard(*storage->rootLock);
+    CascFileStat stat;
+    for (size_t i = begin; i < end; i++) {
+      found[i] = CascLookupFileName(hStorage, names[i].c_str(), stat) ? 1 : 0;
+    }
+  });
+
+  seconds = stopwatch.Micros() / 1e6;
+}
+
+void MatchNameHashesWorker::OnOK() {
+  Napi::Env env = Env();
+  storage->pendingOps--;
+
+  Napi::Uint8Array foundArray = Napi::Uint8Array::New(env, found.size());
+  Napi::Array matched = Napi::Array::New(env);
+  for (size_t i = 0; i < found.size(); i++) {
+    foundArray[i] = found[i];
+    if (found[i]) {
+      matched.Set(matched.Length(), Napi::String::New(env, names[i]));
+    }
+  }
+
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("candidates", Napi::Number::New(env, static_cast<double>(found.size())));
+  result.Set("found", foundArray);
+  result.Set("names", matched);
+  result.Set("seconds", Napi::Number::New(env, seconds));
+  deferred.Resolve(result);
+}
+
+void MatchNameHashesWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+  deferred.Reject(e.Value());
+}
+
+BuildNameIndexWorker::BuildNameIndexWorker(Napi::Env env, CascStorage* storage)
+  : Napi::AsyncWorker(env, "CascBuildNameIndex"),
+    deferred(Napi::Promise::Deferred::New(env)),
+    storageRef(Napi::Persistent(storage->Value())),
+    storage(storage), hStorage(storage->hStorage), index(std::make_unique<CascNameIndex>()) {
+  storage->pendingOps++;
+}
+
+Napi::Promise BuildNameIndexWorker::GetPromise() {
+  return deferred.Promise();
+}
+
+void BuildNameIndexWorker::Execute() {
+  if (!index->Build(hStorage, storage->stats.get(), *storage->rootLock)) {
+    SetError("Failed to enumerate the storage");
+  }
+}
+
+void BuildNameIndexWorker::OnOK() {
+  Napi::Env env = Env();
+  storage->pendingOps--;
+
+  size_t count = index->Count();
+  storage->nameIndex = std::move(index);
+  deferred.Resolve(Napi::Number::New(env, static_cast<double>(count)));
+}
+
+void BuildNameIndexWorker::OnError(const Napi::Error& e) {
+  storage->pendingOps--;
+  deferred.Reject(e.Value());
+}
+
+Napi::Buffer<uint8_t> TakeCdnBuffer(Napi::Env env, LPBYTE data, DWORD size) {
+  return Napi::Buffer<uint8_t>::NewOrCopy(env, data, size,
+    [](Napi::Env /*env*/, uint8_t* finalizeData) { CascCdnFree(finalizeData); });
+}
+
+CdnDownloadManyWorker::CdnDownloadManyWorker(Napi::Env env, std::vector<CdnDownloadItem>&& items, size_t concurrency)
+  : Napi::AsyncProgressQueueWorker<CdnDownloadResult>(env, "CascCdnDownloadMany"),
+    items(std::move(items)), settled(this->items.size(), false),
+    concurrency(concurrency), aborted(false) {
+  deferreds.reserve(this->items.size());
+  for (size_t i = 0; i < this->items.size(); i++) {
+    deferreds.push_back(Napi::Promise::Deferred::New(env));
+  }
+}
+
+Napi::Array CdnDownloadManyWorker::GetPromises() {
+  Napi::Array promises = Napi::Array::New(Env(), deferreds.size());
+  for (size_t i = 0; i < deferreds.size(); i++) {
+    promises.Set((uint32_t)i, deferreds[i].Promise());
+  }
+  return promises;
+}
+
+void CdnDownloadManyWorker::Execute(const ExecutionProgress& progress) {
+  ParallelFor(concurrency, items.size(), aborted, [&](size_t /*workerIndex*/, size_t itemIndex) {
+    const CdnDownloadItem& item = items[itemIndex];
+    CdnDownloadResult result = { (uint32_t)itemIndex, nullptr, 0 };
+
+    // CascLib's error code is process-wide and other downloads overwrite it,
+    // so a failure is reported without one
+    result.data = CascCdnDownload(item.host.c_str(), item.product.c_str(), item.path.c_str(), &result.size);
+    progress.Send(&result, 1);
+  });
+}
+
+void CdnDownloadManyWorker::OnProgress(const CdnDownloadResult* results, size_t count) {
+  Napi::Env env = Env();
+  Napi::HandleScope scope(env);
+
+  for (size_t i = 0; i < count; i++) {
+    const CdnDownloadResult& result = results[i];
+    const CdnDownloadItem& item = items[result.index];
+
+    if (result.data != nullptr) {
+      deferreds[result.index].Resolve(TakeCdnBuffer(env, result.data, result.size));
+    } else {
+      std::string message = "Failed to download " + item.path + " from " + item.host;
+      deferreds[result.index].Reject(Napi::Error::New(env, message).Value());
+    }
+    settled[result.index] = true;
+  }
+}
+
+void CdnDownloadManyWorker::OnOK() {
+  RejectPending(Napi::Error::New(Env(), "CDN download did not complete").Value());
+}
+
+void CdnDownloadManyWorker::OnError(const Napi::Error& e) {
+  RejectPending(e.Value());
+}
+
+void CdnDownloadManyWorker::RejectPending(const Napi::Value& error) {
+  for (size_t i = 0; i < deferreds.size(); i++) {
+    if (!settled[i]) {
+      deferreds[i].Reject(error);
+      settled[i] = true;
+    }
+  }
+}
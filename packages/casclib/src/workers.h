@@ -0,0 +1,348 @@
+#ifndef CASCLIB_WORKERS_H
+#define CASCLIB_WORKERS_H
+
+#include <napi.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "CascLib.h"
+#include "cache.h"
+#include "lookup.h"
+#include "nameindex.h"
+
+class CascStorage;
+
+// One decoded file handed from a pool thread to the JS thread
+struct ReadFilesItem {
+  uint32_t index;
+  uint8_t* data;
+  DWORD size;
+  DWORD error;
+  ContentBlockPtr cached;
+};
+
+// Bounds the files read by ReadFilesWorker but not yet released by the
+// consumer. Pool threads block in Acquire while the window is full; the
+// JS side releases slots as results are consumed. A limit of 0 is unbounded.
+struct ReadFilesWindow {
+  std::mutex lock;
+  std::condition_variable ready;
+  size_t limit = 0;
+  size_t held = 0;
+  bool closed = false;
+
+  // Takes a slot; false once the window is closed
+  bool Acquire();
+  void Release(size_t count);
+  // Wakes every blocked thread; further Acquire calls fail
+  void Close();
+};
+
+// Opens, reads and closes a list of files (names, keys or FileDataIds) on a pool of threads.
+// Each file is delivered to the onFile callback as soon as it is decoded;
+// the returned Promise resolves with the number of delivered files.
+// With a window, each delivered file holds a slot until the release
+// function passed as the second callback argument is called.
+class ReadFilesWorker : public Napi::AsyncProgressQueueWorker<ReadFilesItem> {
+public:
+  ReadFilesWorker(Napi::Env env, CascStorage* storage, CascFileRefs&& files,
+                  DWORD openFlags, size_t concurrency, size_t window, Napi::Function onFile);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute(const ExecutionProgress& progress) override;
+  void OnProgress(const ReadFilesItem* items, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  Napi::FunctionReference onFile;
+  Napi::ObjectReference callbackError;
+  CascStorage* storage;
+  HANDLE hStorage;
+  CascFileRefs files;
+  DWORD openFlags;
+  size_t concurrency;
+  std::shared_ptr<ReadFilesWindow> window;
+  Napi::FunctionReference release;
+  std::atomic<bool> aborted;
+  uint32_t delivered;
+};
+
+// Owned copies of the CascOpenStorageEx arguments, so that they outlive
+// the JS call that supplied them
+struct OpenStorageParams {
+  std::string params;
+  std::string codeName;
+  std::string region;
+  std::string buildKey;
+  std::string cdnHostUrl;
+  DWORD localeMask = CASC_LOCALE_ALL;
+  DWORD flags = 0;
+  bool online = false;
+
+  // The string pointers in args stay valid while this object is alive
+  void FillArgs(CASC_OPEN_STORAGE_ARGS& args) const;
+};
+
+// One CascLib progress notification handed from the open thread to JS
+struct OpenStorageProgress {
+  CASC_PROGRESS_MSG message;
+  std::string object;
+  DWORD current;
+  DWORD total;
+};
+
+// Runs CascOpenStorageEx on the libuv thread pool. Progress messages are
+// forwarded to the optional onProgress callback; returning false from it
+// cancels the open. The returned Promise resolves once the storage is open.
+class OpenStorageWorker : public Napi::AsyncProgressQueueWorker<OpenStorageProgress> {
+public:
+  OpenStorageWorker(Napi::Env env, CascStorage* storage, OpenStorageParams&& params,
+                    Napi::Function onProgress);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute(const ExecutionProgress& progress) override;
+  void OnProgress(const OpenStorageProgress* items, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  static bool WINAPI ProgressCallback(void* param, CASC_PROGRESS_MSG message, LPCSTR szObject,
+                                      DWORD current, DWORD total);
+
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  Napi::FunctionReference onProgress;
+  Napi::ObjectReference callbackError;
+  CascStorage* storage;
+  OpenStorageParams params;
+  const ExecutionProgress* executionProgress;
+  std::atomic<bool> aborted;
+  HANDLE hStorage;
+  uint64_t openMicros;
+};
+
+// Outcome of verifying one content entry
+enum VerifyStatus {
+  VerifyPending,
+  VerifyOk,
+  VerifyMismatch,
+  VerifyMissing,
+  VerifyEncrypted,
+  VerifyFailed
+};
+
+// Throttled progress update sent from the verify threads to JS
+struct VerifyProgress {
+  uint32_t filesChecked;
+  uint32_t filesTotal;
+  uint64_t bytesChecked;
+};
+
+// Enumerates a mask and checks the MD5 of every decoded file against its
+// CKey on a pool of threads. Each CKey is verified once, whatever the number
+// of names that refer to it. The returned Promise resolves with a summary
+// listing mismatched, missing, encrypted and failed files.
+class VerifyWorker : public Napi::AsyncProgressQueueWorker<VerifyProgress> {
+public:
+  VerifyWorker(Napi::Env env, CascStorage* storage, std::string&& mask, std::string&& listFile,
+               size_t threads, Napi::Function onProgress);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute(const ExecutionProgress& progress) override;
+  void OnProgress(const VerifyProgress* items, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  struct Entry {
+    std::string name;
+    BYTE ckey[MD5_HASH_SIZE];
+    bool available;
+    VerifyStatus status;
+    DWORD error;
+  };
+
+  VerifyStatus VerifyEntry(Entry& entry, std::vector<uint8_t>& buffer, uint64_t& bytesRead);
+
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  Napi::FunctionReference onProgress;
+  Napi::ObjectReference callbackError;
+  CascStorage* storage;
+  HANDLE hStorage;
+  std::string mask;
+  std::string listFile;
+  size_t threads;
+  std::vector<Entry> entries;
+  std::atomic<bool> aborted;
+  std::atomic<uint32_t> filesChecked;
+  std::atomic<uint64_t> bytesChecked;
+  double seconds;
+};
+
+// Throttled progress update sent from the extract threads to JS
+struct ExtractProgress {
+  uint32_t filesDone;
+  uint32_t filesTotal;
+  uint64_t bytesWritten;
+};
+
+// Enumerates a mask and writes every file below an output directory from a
+// pool of threads, preserving the directory structure. Output files that
+// already have the right size and MD5 are skipped. The returned Promise
+// resolves with counts, failures and throughput.
+class ExtractWorker : public Napi::AsyncProgressQueueWorker<ExtractProgress> {
+public:
+  ExtractWorker(Napi::Env env, CascStorage* storage, std::string&& mask, std::string&& outDir,
+                std::string&& listFile, size_t threads, Napi::Function onProgress);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute(const ExecutionProgress& progress) override;
+  void OnProgress(const ExtractProgress* items, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  enum Status {
+    ExtractPending,
+    ExtractWritten,
+    ExtractSkipped,
+    ExtractFailed
+  };
+
+  struct Entry {
+    std::string name;
+    BYTE ckey[MD5_HASH_SIZE];
+    ULONGLONG size;
+    Status status;
+    DWORD error;
+  };
+
+  Status ExtractEntry(Entry& entry, std::vector<uint8_t>& buffer, uint64_t& bytesWritten);
+
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  Napi::FunctionReference onProgress;
+  Napi::ObjectReference callbackError;
+  CascStorage* storage;
+  HANDLE hStorage;
+  std::string mask;
+  std::string outDir;
+  std::string listFile;
+  size_t threads;
+  std::vector<Entry> entries;
+  std::atomic<bool> aborted;
+  std::atomic<uint32_t> filesDone;
+  std::atomic<uint64_t> bytesWritten;
+  double seconds;
+};
+
+// Checks candidate names against a name-hashed root (CASC_FEATURE_FNAME_HASHES)
+// on a pool of threads. Each name is resolved through the root handler with
+// CascLookupFileName; no file is opened and no encoding entry is read, so
+// millions of listfile names can be checked in one call. Names come from an array or from the lines of a listfile
+// ("id;name" lines are accepted as well). The returned Promise resolves with
+// a flag per candidate and the matched names.
+class MatchNameHashesWorker : public Napi::AsyncWorker {
+public:
+  MatchNameHashesWorker(Napi::Env env, CascStorage* storage, HANDLE hStorage, std::vector<std::string>&& names,
+                        std::string&& listFile, size_t threads);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  CascStorage* storage;
+  HANDLE hStorage;
+  std::vector<std::string> names;
+  std::string listFile;
+  size_t threads;
+  std::vector<uint8_t> found;
+  double seconds;
+};
+
+// Enumerates the storage on a pool thread and sorts its names for
+// findPrefix and listDirectory. The index is handed to the storage on the JS
+// thread; the returned Promise resolves with the number of names.
+class BuildNameIndexWorker : public Napi::AsyncWorker {
+public:
+  BuildNameIndexWorker(Napi::Env env, CascStorage* storage);
+
+  Napi::Promise GetPromise();
+
+protected:
+  void Execute() override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  Napi::Promise::Deferred deferred;
+  Napi::ObjectReference storageRef;
+  CascStorage* storage;
+  HANDLE hStorage;
+  std::unique_ptr<CascNameIndex> index;
+};
+
+// Wraps memory returned by CascCdnDownload in a Buffer without copying;
+// the Buffer's finalizer hands it back to CascCdnFree
+Napi::Buffer<uint8_t> TakeCdnBuffer(Napi::Env env, LPBYTE data, DWORD size);
+
+// One file to fetch with CascCdnDownload
+struct CdnDownloadItem {
+  std::string host;
+  std::string product;
+  std::string path;
+};
+
+// One finished download handed from a pool thread to the JS thread
+struct CdnDownloadResult {
+  uint32_t index;
+  LPBYTE data;
+  DWORD size;
+};
+
+// Downloads a list of CDN files on a pool of threads. Each item has its own
+// Promise, settled on the JS thread as soon as its download finishes.
+class CdnDownloadManyWorker : public Napi::AsyncProgressQueueWorker<CdnDownloadResult> {
+public:
+  CdnDownloadManyWorker(Napi::Env env, std::vector<CdnDownloadItem>&& items, size_t concurrency);
+
+  Napi::Array GetPromises();
+
+protected:
+  void Execute(const ExecutionProgress& progress) override;
+  void OnProgress(const CdnDownloadResult* results, size_t count) override;
+  void OnOK() override;
+  void OnError(const Napi::Error& e) override;
+
+private:
+  void RejectPending(const Napi::Value& error);
+
+  std::vector<CdnDownloadItem> items;
+  std::vector<Napi::Promise::Deferred> deferreds;
+  std::vector<bool> settled;
+  size_t concurrency;
+  std::atomic<bool> aborted;
+};
+
+#endif // CASCLIB_WORKERS_H
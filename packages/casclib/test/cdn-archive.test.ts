@@ -0,0 +1,214 @@
+import { CdnArchiveReader, decodeBlte, verifyBlte } from "../lib/cdn";
+import { OnlineCache } from "../lib/onlinecache";
+import * as crypto from "crypto";
+import * as fs from "fs";
+import * as http from "http";
+import * as os from "os";
+import * as path from "path";
+import * as zlib from "zlib";
+
+// Single-frame BLTE stream; zlib-compressed when compress is set
+function encodeBlte(content: Buffer, compress: boolean): Buffer {
+  const frame = compress
+    ? Buffer.concat([Buffer.from("Z"), zlib.deflateSync(content)])
+    : Buffer.concat([Buffer.from("N"), content]);
+  const header = Buffer.alloc(8);
+  header.write("BLTE", 0, "latin1");
+  return Buffer.concat([header, frame]);
+}
+
+// CDN archive index with 4 KB blocks, 4-byte sizes and offsets and 8-byte checksums
+function buildArchiveIndex(entries: { ekey: Buffer; size: number; offset: number }[]): Buffer {
+  const sorted = [...entries].sort((a, b) => Buffer.compare(a.ekey, b.ekey));
+  const block = Buffer.alloc(4096);
+  sorted.forEach((entry, i) => {
+    entry.ekey.copy(block, i * 24);
+    block.writeUInt32BE(entry.size, i * 24 + 16);
+    block.writeUInt32BE(entry.offset, i * 24 + 20);
+  });
+
+  const toc = Buffer.alloc(16 + 8);
+  sorted[sorted.length - 1].ekey.copy(toc, 0);
+
+  const footer = Buffer.alloc(28);
+  Buffer.from([1, 0, 0, 4, 4, 4, 16, 8]).copy(footer, 8);
+  footer.writeUInt32LE(sorted.length, 16);
+  return Buffer.concat([block, toc, footer]);
+}
+
+describe("CdnArchiveReader", () => {
+  const archiveKey = "0123456789abcdef0123456789abcdef";
+  const contents = [0, 1, 2].map((i) => crypto.randomBytes(1000 + i * 5000));
+  const encoded = contents.map((content, i) => encodeBlte(content, i % 2 === 0));
+  const ekeys = encoded.map((data) => crypto.createHash("md5").update(data).digest());
+  const padding = crypto.randomBytes(100000);
+  const archive = Buffer.concat([padding, ...encoded]);
+  const index = buildArchiveIndex(encoded.map((data, i) => ({
+    ekey: ekeys[i],
+    size: data.length,
+    offset: padding.length + encoded.slice(0, i).reduce((sum, item) => sum + item.length, 0)
+  })));
+
+  const files: Record<string, Buffer> = {
+    [`/tpr/test/data/01/23/${archiveKey}`]: archive,
+    [`/tpr/test/data/01/23/${archiveKey}.index`]: index
+  };
+  const requests: { url: string; range?: string }[] = [];
+  let connections = 0;
+  let server: http.Server;
+  let cdnUrl: string;
+  let cacheDir: string;
+
+  beforeAll(async () => {
+    server = http.createServer((request, response) => {
+      const data = files[request.url || ""];
+      requests.push({ url: request.url || "", range: request.headers.range });
+      if (!data) {
+        response.writeHead(404);
+        response.end();
+        return;
+      }
+
+      const match = /^bytes=(\d+)-(\d+)$/.exec(request.headers.range || "");
+      if (match) {
+        const start = Number(match[1]);
+        const end = Number(match[2]);
+        response.writeHead(206, { "Content-Range": `bytes ${start}-${end}/${data.length}` });
+        response.end(data.subarray(start, end + 1));
+      } else {
+        response.writeHead(200);
+        response.end(data);
+      }
+    });
+    server.on("connection", () => connections++);
+    await new Promise<void>((resolve) => server.listen(0, "127.0.0.1", resolve));
+    cdnUrl = `http://127.0.0.1:${(server.address() as { port: number }).port}/tpr/test`;
+    cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), "CASCLIB_CDN_"));
+  });
+
+  afterAll(async () => {
+    fs.rmSync(cacheDir, { recursive: true, force: true });
+    await new Promise((resolve) => server.close(resolve));
+  });
+
+  it("should decode BLTE streams", async () => {
+    expect((await decodeBlte(encoded[0])).equals(contents[0])).toBe(true);
+    expect((await decodeBlte(encoded[1])).equals(contents[1])).toBe(true);
+    await expect(decodeBlte(Buffer.from("not blte"))).rejects.toThrow();
+  });
+
+  it("should check BLTE frames against the hashes in the header", async () => {
+    const parts = [crypto.randomBytes(300), crypto.randomBytes(500)];
+    const frames = parts.map((part) => Buffer.concat([Buffer.from("N"), part]));
+    const header = Buffer.alloc(12 + frames.length * 24);
+    header.write("BLTE", 0, "latin1");
+    header.writeUInt32BE(header.length, 4);
+    header.writeUInt32BE(frames.length, 8);
+    header[8] = 0x0f;
+    frames.forEach((frame, i) => {
+      header.writeUInt32BE(frame.length, 12 + i * 24);
+      header.writeUInt32BE(frame.length - 1, 16 + i * 24);
+      crypto.createHash("md5").update(frame).digest().copy(header, 20 + i * 24);
+    });
+    const stream = Buffer.concat([header, ...frames]);
+    const ekey = crypto.createHash("md5").update(header).digest();
+
+    expect(verifyBlte(stream, ekey)).toBe(true);
+    expect((await decodeBlte(stream)).equals(Buffer.concat(parts))).toBe(true);
+
+    const corrupt = Buffer.from(stream);
+    corrupt[corrupt.length - 1] ^= 0xff;
+    expect(verifyBlte(corrupt, ekey)).toBe(false);
+    await expect(decodeBlte(corrupt)).rejects.toThrow(/hash/);
+    expect(verifyBlte(encoded[0], ekeys[1])).toBe(false);
+  });
+
+  it("should fetch only the ranges of requested EKeys and reuse them after reopening", async () => {
+    const onlineCache = new OnlineCache(cacheDir, { maxBytes: 1 << 30 });
+    const reader = new CdnArchiveReader({ cdnUrl, archives: [archiveKey], cacheDir, onlineCache });
+    await reader.loadIndexes();
+
+    expect(reader.has(ekeys[1])).toBe(true);
+    expect(reader.has(crypto.randomBytes(16))).toBe(false);
+
+    expect((await reader.read(ekeys[1])).equals(contents[1])).toBe(true);
+    expect((await reader.read(ekeys[2].toString("hex"))).equals(contents[2])).toBe(true);
+
+    const archiveRequests = requests.filter((request) => request.url.endsWith(archiveKey));
+    expect(archiveRequests.length).toBe(2);
+    expect(archiveRequests.every((request) => request.range)).toBe(true);
+    expect(reader.getStats().bytesFetched).toBe(encoded[1].length + encoded[2].length);
+    expect(reader.getStats().cacheMisses).toBe(2);
+    expect(reader.getStats().hitRate).toBe(0);
+    reader.close();
+
+    // A new reader finds the index and both ranges in the cache folder
+    requests.length = 0;
+    const reopened = new CdnArchiveReader({ cdnUrl, archives: [archiveKey], cacheDir, onlineCache });
+    await reopened.loadIndexes();
+    expect((await reopened.read(ekeys[1])).equals(contents[1])).toBe(true);
+    expect((await reopened.read(ekeys[2])).equals(contents[2])).toBe(true);
+    expect(requests.length).toBe(0);
+    expect(reopened.getStats().cacheHits).toBe(2);
+
+    // The sparse file only holds what was fetched
+    expect((await reopened.read(ekeys[0])).equals(contents[0])).toBe(true);
+    expect(requests.length).toBe(1);
+    expect(reopened.getStats().cacheMisses).toBe(1);
+    expect(reopened.getStats().hitRate).toBeCloseTo(2 / 3);
+    reopened.close();
+
+    // Both readers counted their reads in the cache manager of the folder
+    const stats = onlineCache.getStats();
+    expect(stats.hits).toBe(2);
+    expect(stats.misses).toBe(3);
+    expect(stats.hitRate).toBeCloseTo(0.4);
+  });
+
+  it("should not cache ranges that fail their hash check", async () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), "CASCLIB_CDN_"));
+    const reader = new CdnArchiveReader({ cdnUrl, archives: [archiveKey], cacheDir: dir });
+    const original = files[`/tpr/test/data/01/23/${archiveKey}`];
+    const damaged = Buffer.from(original);
+    damaged[padding.length + 20] ^= 0xff;
+
+    try {
+      await reader.loadIndexes();
+      files[`/tpr/test/data/01/23/${archiveKey}`] = damaged;
+      await expect(reader.read(ekeys[0])).rejects.toThrow(/does not match/);
+      expect(fs.existsSync(path.join(dir, "data", "01", "23", `${archiveKey}.ranges`))).toBe(false);
+
+      files[`/tpr/test/data/01/23/${archiveKey}`] = original;
+      expect((await reader.read(ekeys[0], crypto.createHash("md5").update(contents[0]).digest())).equals(contents[0])).toBe(true);
+      await expect(reader.read(ekeys[1], crypto.randomBytes(16))).rejects.toThrow(/CKey/);
+      expect(fs.readdirSync(path.join(dir, "data", "01", "23")).some((name) => name.endsWith(".tmp"))).toBe(false);
+    } finally {
+      files[`/tpr/test/data/01/23/${archiveKey}`] = original;
+      reader.close();
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  });
+
+  it("should split large entries into parallel ranges over reused connections", async () => {
+    const dir = fs.mkdtempSync(path.join(os.tmpdir(), "CASCLIB_CDN_"));
+    const reader = new CdnArchiveReader({ cdnUrl, archives: [archiveKey], cacheDir: dir, concurrency: 2, rangeSize: 1024 });
+
+    try {
+      await reader.loadIndexes();
+      requests.length = 0;
+      connections = 0;
+
+      const results = await reader.readMany([ekeys[0], ekeys[1], ekeys[2]]);
+      results.forEach((result, i) => expect(result.equals(contents[i])).toBe(true));
+
+      // Every entry is larger than one range, and no more than two sockets are opened
+      const expected = encoded.reduce((sum, data) => sum + Math.ceil(data.length / 1024), 0);
+      expect(requests.length).toBe(expected);
+      expect(reader.getStats().rangeRequests).toBe(expected);
+      expect(connections).toBeLessThanOrEqual(2);
+    } finally {
+      reader.close();
+      fs.rmSync(dir, { recursive: true, force: true });
+    }
+  });
+});
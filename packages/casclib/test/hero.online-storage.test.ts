@@ -1,6 +1,7 @@
-import { Storage, File } from "../lib";
+import { Storage, File, CascOpenLocalFile, getFindBatchName, CASC_OPEN_BY_EKEY, setContentCacheLimit, getContentCacheStats, clearContentCache, CascFileSpanInfo, cdnDownloadMany, CascStorageFeatures, CASC_FEATURE_FNAME_HASHES } from "../lib";
 import * as fs from "fs";
 import * as os from "os";
+import * as path from "path";
 
 const TEMP_DIR = os.tmpdir() + "/CASCLIB_TESTS_hero";
 
@@ -49,6 +50,65 @@ describe("CascLib - Heroes of the Storm (hero)", () => {
       expect(fileCount).toBeGreaterThan(1);
     });
 
+    it("should list the same XML files with findBatch as with findNextFile", () => {
+      const names: string[] = [];
+      let findData = storage.findFirstFile("*.xml");
+      while (findData) {
+        names.push(findData.fileName);
+        findData = storage.findNextFile();
+      }
+      storage.findClose();
+
+      const batchNames: string[] = [];
+      let batch = storage.findBatch("*.xml", 500);
+      while (batch) {
+        expect(batch.ckeys.length).toBe(batch.count * 16);
+        expect(batch.fileSizes.length).toBe(batch.count);
+        for (let i = 0; i < batch.count; i++) {
+          batchNames.push(getFindBatchName(batch, i));
+        }
+        batch = storage.findBatch(null, 500);
+      }
+
+      expect(batchNames).toEqual(names);
+    });
+
+    it("should enumerate two masks concurrently with find iterators", async () => {
+      const collect = async (mask: string) => {
+        const names: string[] = [];
+        for await (const findData of storage.createFindIterator(mask, { batchSize: 256 })) {
+          names.push(findData.fileName);
+        }
+        return names;
+      };
+
+      const [xmlNames, txtNames] = await Promise.all([collect("*.xml"), collect("*.txt")]);
+
+      expect(xmlNames.length).toBeGreaterThan(1);
+      expect(txtNames.length).toBeGreaterThan(0);
+      expect(xmlNames.every((name) => name.toLowerCase().endsWith(".xml"))).toBe(true);
+      expect(txtNames.every((name) => name.toLowerCase().endsWith(".txt"))).toBe(true);
+    });
+
+    it("should list directories and find names by prefix", async () => {
+      const [count, again] = await Promise.all([storage.buildNameIndex(), storage.buildNameIndex()]);
+      expect(count).toBeGreaterThan(0);
+      expect(again).toBe(count);
+
+      const root = await storage.listDirectory();
+      expect(root.directories.map((name) => name.toLowerCase())).toContain("mods");
+
+      const listing = await storage.listDirectory("MODS\\core.stormmod\\base.stormdata");
+      expect(listing.files.map((name) => name.toLowerCase())).toContain("databuildid.txt");
+      expect(listing.files.every((name) => !name.includes("/"))).toBe(true);
+
+      const names = await storage.findPrefix("mods/core.stormmod/base.stormdata/");
+      expect(names.length).toBeGreaterThan(0);
+      expect(names.every((name) => name.toLowerCase().replace(/\\/g, "/").startsWith("mods/core.stormmod/base.stormdata/"))).toBe(true);
+      expect(names.length).toBeGreaterThanOrEqual(listing.files.length);
+      expect(await storage.findPrefix("no/such/prefix/")).toEqual([]);
+    });
+
     it("should read DataBuildId.txt and content should start with 'B'", () => {
       const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
       expect(storage.fileExists(fileName)).toBe(true);
@@ -73,6 +133,109 @@ describe("CascLib - Heroes of the Storm (hero)", () => {
       expect(info?.size).toBeGreaterThan(0);
     });
 
+    it("should check and stat many files in one call", () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const names = [fileName, "non/existent/file.txt"];
+
+      expect(Array.from(storage.existsMany(names))).toEqual([1, 0]);
+
+      const stat = storage.statMany(names);
+      expect(Array.from(stat.found)).toEqual([1, 0]);
+      expect(stat.sizes[0]).toBe(storage.getFileInfo(fileName)?.size);
+      expect(stat.ckeys.length).toBe(names.length * 16);
+      expect(stat.ckeys.subarray(0, 16).some((b) => b !== 0)).toBe(true);
+      expect(stat.ekeys.subarray(16, 32).every((b) => b === 0)).toBe(true);
+    });
+
+    it("should match candidate names from an array and from listfile content", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      expect((storage.getStorageInfo(CascStorageFeatures).features! & CASC_FEATURE_FNAME_HASHES) !== 0).toBe(true);
+
+      const fromArray = await storage.matchNameHashes([fileName, "non/existent/file.txt"], 2);
+      expect(fromArray.candidates).toBe(2);
+      expect(Array.from(fromArray.found)).toEqual([1, 0]);
+      expect(fromArray.names).toEqual([fileName]);
+
+      const listFile = Buffer.from(`non/existent/file.txt\r\n\r\n12345;${fileName}\r\n`);
+      const fromListFile = await storage.matchNameHashes(listFile);
+      expect(fromListFile.candidates).toBe(2);
+      expect(Array.from(fromListFile.found)).toEqual([0, 1]);
+      expect(fromListFile.names).toEqual([fileName]);
+    });
+
+    it("should open and stat files by binary CKey and EKey", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+      const content = file.readAll();
+      file.close();
+
+      const stat = storage.statMany([fileName]);
+      const ckey = stat.ckeys.subarray(0, 16);
+      const ekey = stat.ekeys.subarray(0, 16);
+
+      const byCKey = storage.openFile(Buffer.from(ckey));
+      expect(byCKey.readAll().equals(content)).toBe(true);
+      byCKey.close();
+
+      const byEKey = storage.openFile(Buffer.from(ekey), { flags: CASC_OPEN_BY_EKEY });
+      expect(byEKey.readAll().equals(content)).toBe(true);
+      byEKey.close();
+
+      const keys = Buffer.concat([ckey, Buffer.alloc(16)]);
+      expect(Array.from(storage.existsMany(keys))).toEqual([1, 0]);
+      expect(storage.statMany(keys).sizes[0]).toBe(content.length);
+
+      const results = [];
+      for await (const result of storage.readFiles(keys)) {
+        results[result.index] = result;
+      }
+      expect(results[0].name).toBe(ckey.toString("hex"));
+      expect(results[0].data?.equals(content)).toBe(true);
+      expect(results[1].data).toBeNull();
+    });
+
+    it("should verify the content of matching files against their CKeys", async () => {
+      const progress: number[] = [];
+      const result = await storage.verifyAll({
+        mask: "*DataBuildId.txt",
+        threads: 2,
+        onProgress: (p) => {
+          progress.push(p.filesChecked);
+        },
+      });
+
+      expect(result.aborted).toBe(false);
+      expect(result.filesTotal).toBeGreaterThan(0);
+      expect(result.filesChecked).toBe(result.filesTotal);
+      expect(result.ok).toBe(result.filesTotal);
+      expect(result.mismatched).toEqual([]);
+      expect(result.bytesChecked).toBeGreaterThan(0);
+      expect(progress[progress.length - 1]).toBe(result.filesTotal);
+    });
+
+    it("should extract matching files and skip them when up to date", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const outDir = fs.mkdtempSync(os.tmpdir() + "/CASCLIB_EXTRACT_");
+
+      try {
+        const first = await storage.extract("*DataBuildId.txt", outDir, { threads: 2 });
+        expect(first.failed).toEqual([]);
+        expect(first.filesWritten).toBe(first.filesTotal);
+        expect(first.filesTotal).toBeGreaterThan(0);
+
+        const file = storage.openFile(fileName);
+        const content = file.readAll();
+        file.close();
+        expect(fs.readFileSync(`${outDir}/${fileName}`).equals(content)).toBe(true);
+
+        const second = await storage.extract("*DataBuildId.txt", outDir, { threads: 2 });
+        expect(second.filesWritten).toBe(0);
+        expect(second.filesSkipped).toBe(first.filesTotal);
+      } finally {
+        fs.rmSync(outDir, { recursive: true, force: true });
+      }
+    });
+
     it("should verify file does not exist for invalid path", () => {
       const invalidFileName = "non/existent/file.txt";
       const exists = storage.fileExists(invalidFileName);
@@ -169,6 +332,301 @@ describe("CascLib - Heroes of the Storm (hero)", () => {
       // Both should read the same content
       expect(content1.equals(content2)).toBe(true);
     });
+
+    it("should read a file into a caller-supplied buffer", () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+      const expected = file.readAll();
+      file.setPosition(0);
+
+      const scratch = Buffer.alloc(expected.length + 16);
+      const bytesRead = file.readInto(scratch, 16);
+
+      expect(bytesRead).toBe(expected.length);
+      expect(scratch.subarray(16, 16 + bytesRead).equals(expected)).toBe(true);
+
+      file.close();
+    });
+
+    it("should read many files in parallel with readFiles", async () => {
+      const existing = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const missing = "non/existent/file.txt";
+      const names = [existing, missing, existing];
+
+      const file = storage.openFile(existing);
+      const expected = file.readAll();
+      file.close();
+
+      const results = [];
+      for await (const result of storage.readFiles(names, { concurrency: 2 })) {
+        results.push(result);
+      }
+
+      expect(results.length).toBe(names.length);
+      for (const result of results) {
+        expect(result.name).toBe(names[result.index]);
+        if (result.name === existing) {
+          expect(result.data?.equals(expected)).toBe(true);
+        } else {
+          expect(result.data).toBeNull();
+          expect(result.error).toBeGreaterThan(0);
+        }
+      }
+    });
+
+    it("should pause readFiles workers behind a slow consumer and stop on break", async () => {
+      const existing = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const names = Array.from({ length: 8 }, () => existing);
+
+      let count = 0;
+      for await (const result of storage.readFiles(names, { concurrency: 2, highWaterMark: 1 })) {
+        expect(result.data).not.toBeNull();
+        await new Promise((resolve) => setTimeout(resolve, 5));
+        count++;
+      }
+      expect(count).toBe(names.length);
+
+      // Breaking out while the window is full must not leave workers blocked;
+      // the loop only exits once the native read has settled
+      for await (const result of storage.readFiles(names, { concurrency: 2, highWaterMark: 1 })) {
+        expect(result.data).not.toBeNull();
+        break;
+      }
+    });
+
+    it("should read a file asynchronously with the same content as readAll", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+
+      const file1 = storage.openFile(fileName);
+      const syncContent = file1.readAll();
+      file1.close();
+
+      const file2 = storage.openFile(fileName);
+      const asyncContent = await file2.readAllAsync();
+      file2.close();
+
+      expect(asyncContent.equals(syncContent)).toBe(true);
+    });
+
+    it("should reject size and info queries while an asynchronous read is pending", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+
+      const pending = file.readAllAsync();
+      expect(() => file.getSize()).toThrow(/pending asynchronous operation/);
+      expect(() => file.getSize64()).toThrow(/pending asynchronous operation/);
+      expect(() => file.getFileInfo(CascFileSpanInfo)).toThrow(/pending asynchronous operation/);
+      expect(() => file.readAt(0, 1)).toThrow(/pending asynchronous operation/);
+
+      const content = await pending;
+      expect(file.getSize64()).toBe(content.length);
+      file.close();
+    });
+
+    it("should stream a byte range that matches readAll", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+      const content = file.readAll();
+      expect(content.length).toBeGreaterThan(4);
+
+      const end = content.length - 2;
+      const chunks: Buffer[] = [];
+      for await (const chunk of file.createReadStream({ highWaterMark: 3, start: 1, end, autoClose: true })) {
+        expect(chunk.length).toBeLessThanOrEqual(3);
+        chunks.push(chunk);
+      }
+
+      expect(Buffer.concat(chunks).equals(content.subarray(1, end + 1))).toBe(true);
+    });
+
+    it("should serve repeated whole-file reads from the content cache", () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      setContentCacheLimit(1024 * 1024);
+
+      try {
+        const before = getContentCacheStats();
+
+        const file1 = storage.openFile(fileName);
+        const first = file1.readAll();
+        file1.close();
+
+        const file2 = storage.openFile(fileName);
+        const second = file2.readAll();
+        expect(file2.getPosition64()).toBe(second.length);
+        file2.close();
+
+        const after = getContentCacheStats();
+        expect(second.equals(first)).toBe(true);
+        expect(after.misses - before.misses).toBe(1);
+        expect(after.hits - before.hits).toBe(1);
+        expect(after.bytes).toBeLessThanOrEqual(after.limit);
+      } finally {
+        setContentCacheLimit(0);
+        clearContentCache();
+      }
+
+      expect(getContentCacheStats().entries).toBe(0);
+    });
+
+    it("should bypass the content cache for files without a CKey", () => {
+      // Plain BLTE: magic, zero header size, then one raw ('N') frame
+      const blte = (text: string) => Buffer.concat([Buffer.from("BLTE"), Buffer.alloc(4), Buffer.from("N" + text)]);
+      fs.mkdirSync(TEMP_DIR, { recursive: true });
+      const pathA = path.join(TEMP_DIR, "local-a.blte");
+      const pathB = path.join(TEMP_DIR, "local-b.blte");
+      fs.writeFileSync(pathA, blte("first local file"));
+      fs.writeFileSync(pathB, blte("second local file"));
+
+      setContentCacheLimit(1024 * 1024);
+      try {
+        const before = getContentCacheStats();
+
+        const fileA = new File(CascOpenLocalFile(pathA));
+        const first = fileA.readAll();
+        fileA.close();
+
+        const fileB = new File(CascOpenLocalFile(pathB));
+        const second = fileB.readAll();
+        fileB.close();
+
+        expect(first.toString()).toBe("first local file");
+        expect(second.toString()).toBe("second local file");
+        expect(getContentCacheStats().insertions).toBe(before.insertions);
+      } finally {
+        setContentCacheLimit(0);
+        clearContentCache();
+      }
+    });
+
+    it("should skip the content cache for content larger than the budget", () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      setContentCacheLimit(1);
+
+      try {
+        const before = getContentCacheStats();
+
+        const file = storage.openFile(fileName);
+        const data = file.readAll();
+        file.close();
+
+        const after = getContentCacheStats();
+        expect(data.length).toBeGreaterThan(1);
+        expect(after.misses).toBe(before.misses);
+        expect(after.insertions).toBe(before.insertions);
+      } finally {
+        setContentCacheLimit(0);
+        clearContentCache();
+      }
+    });
+
+    it("should read ranges with readAt without moving the file position", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+      const content = file.readAll();
+      file.setPosition64(0);
+
+      expect(file.readAt(1, 3).equals(content.subarray(1, 4))).toBe(true);
+      expect(file.getPosition64()).toBe(0);
+
+      const ranges = await Promise.all([
+        file.readAtAsync(0, 2),
+        file.readAtAsync(2, content.length),
+        file.readAtAsync(content.length, 10),
+      ]);
+      expect(ranges[0].equals(content.subarray(0, 2))).toBe(true);
+      expect(ranges[1].equals(content.subarray(2))).toBe(true);
+      expect(ranges[2].length).toBe(0);
+
+      file.close();
+    });
+
+    it("should list frames and decode them individually with readFrames", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+      const content = file.readAll();
+
+      const { spans } = file.getFileInfo(CascFileSpanInfo);
+      expect(spans!.length).toBeGreaterThan(0);
+
+      const frames = file.getFrames();
+      expect(frames.count).toBeGreaterThan(0);
+      const total = frames.contentSizes.reduce((sum, size) => sum + size, 0);
+      expect(total).toBe(content.length);
+
+      const last = frames.count - 1;
+      const tail = file.readFrames(last, 1);
+      expect(tail.equals(content.subarray(frames.contentOffsets[last]))).toBe(true);
+      expect((await file.readFramesAsync(0, frames.count)).equals(content)).toBe(true);
+      expect(() => file.readFrames(frames.count, 1)).toThrow(RangeError);
+
+      file.close();
+    });
+
+    it("should list the frames of every span before any read", async () => {
+      // The smallest multi-span file, or a single-span one if the build has none
+      let fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      let smallest = Infinity;
+      for await (const batch of storage.createFindIterator("*").batches()) {
+        for (let i = 0; i < batch.count; i++) {
+          if (batch.spanCounts[i] > 1 && batch.available[i] && batch.fileSizes[i] < smallest) {
+            smallest = batch.fileSizes[i];
+            fileName = getFindBatchName(batch, i);
+          }
+        }
+      }
+
+      const file = storage.openFile(fileName);
+      const { spans } = file.getFileInfo(CascFileSpanInfo);
+      const frames = file.getFrames();
+
+      const spanIndexes = new Set(frames.spanIndexes);
+      expect(spanIndexes.size).toBe(spans!.length);
+      for (let i = 1; i < frames.count; i++) {
+        expect(frames.contentOffsets[i]).toBe(frames.contentOffsets[i - 1] + frames.contentSizes[i - 1]);
+      }
+
+      const content = await file.readFramesAsync(0, frames.count);
+      expect(content.length).toBe(file.getSize64());
+      file.setPosition64(0);
+      expect(content.equals(file.readAll())).toBe(true);
+      file.close();
+    });
+
+    it("should count opens, reads and failed lookups in getStats", () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      storage.resetStats();
+
+      const file = storage.openFile(fileName);
+      const content = file.read(1 << 20);
+      file.close();
+      storage.fileExists("invalid/path/to/file.txt");
+
+      const stats = storage.getStats();
+      expect(stats.filesOpened).toBe(1);
+      expect(stats.filesClosed).toBe(1);
+      expect(stats.reads).toBe(1);
+      expect(stats.bytesRead).toBe(content.length);
+      expect(stats.readTime.count).toBe(1);
+      expect(stats.readTime.buckets.reduce((sum, n) => sum + n, 0)).toBe(1);
+      expect(stats.lookupFailures).toBe(1);
+
+      storage.resetStats();
+      expect(storage.getStats().reads).toBe(0);
+    });
+
+    it("should reject a second operation while an async read is pending", async () => {
+      const fileName = "mods/core.stormmod/base.stormdata/DataBuildId.txt";
+      const file = storage.openFile(fileName);
+
+      const pending = file.readAsync(5);
+      expect(() => file.read(5)).toThrow();
+      expect(() => file.close()).toThrow();
+
+      const chunk = await pending;
+      expect(chunk.length).toBeLessThanOrEqual(5);
+
+      file.close();
+    });
   });
 
   describe("CascStorage", () => {
@@ -193,6 +651,46 @@ describe("CascLib - Heroes of the Storm (hero)", () => {
         storage.open("/non/existent/path");
       }).toThrow();
     });
+
+    it("should reject openAsync for non-existent storage", async () => {
+      await expect(storage.openAsync("/non/existent/path")).rejects.toThrow();
+      expect(() => storage.fileExists("any")).toThrow();
+    });
+
+    it("should cancel openAsync from the progress callback", async () => {
+      const messages: number[] = [];
+
+      await expect(
+        storage.openAsync(`${TEMP_DIR}*hero*us`, {
+          online: true,
+          onProgress: (progress) => {
+            messages.push(progress.message);
+            return false;
+          },
+        })
+      ).rejects.toThrow();
+
+      expect(messages.length).toBeGreaterThan(0);
+      expect(() => storage.fileExists("any")).toThrow();
+      fs.rmSync(TEMP_DIR, { recursive: true, force: true });
+    });
+  });
+
+  describe("CDN downloads", () => {
+    it("should settle one cdnDownloadMany promise per item", async () => {
+      expect(() => cdnDownloadMany([{ host: "127.0.0.1:1" } as any])).toThrow(TypeError);
+      expect(cdnDownloadMany([])).toEqual([]);
+
+      // Nothing listens on port 1, so every download fails on its own
+      const items = [1, 2, 3].map((n) => ({ host: "127.0.0.1:1", product: "hero", path: `config/00/00/${n}` }));
+      const promises = cdnDownloadMany(items, { concurrency: 2 });
+      expect(promises.length).toBe(items.length);
+
+      const results = await Promise.allSettled(promises);
+      for (const result of results) {
+        expect(result.status).toBe("rejected");
+      }
+    });
   });
 
   describe("Module exports", () => {
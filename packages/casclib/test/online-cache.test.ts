@@ -0,0 +1,114 @@
+import { OnlineCache } from "../lib/onlinecache";
+import * as fs from "fs";
+import * as os from "os";
+import * as path from "path";
+
+const key = (n: number) => n.toString(16).padStart(32, "0");
+
+// Writes a file under the CDN layout (<type>/<k[0:2]>/<k[2:4]>/<key><suffix>) with the given access time
+function writeCacheFile(dir: string, type: string, name: string, data: string | Buffer, accessed: number): string {
+  const file = path.join(dir, type, name.substring(0, 2), name.substring(2, 4), name);
+  fs.mkdirSync(path.dirname(file), { recursive: true });
+  fs.writeFileSync(file, data);
+  fs.utimesSync(file, new Date(accessed), new Date(accessed));
+  return file;
+}
+
+describe("OnlineCache", () => {
+  let dir: string;
+
+  beforeEach(() => {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), "CASCLIB_ONLINE_CACHE_"));
+  });
+
+  afterEach(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it("should evict least recently used files but keep the current build's configs and indexes", () => {
+    const day = 24 * 3600 * 1000;
+    const now = Date.now();
+
+    // An old build, and the current build whose CDN config lists archive 0x20
+    writeCacheFile(dir, "config", key(1), `# Build Configuration\n\nencoding = ${key(2)} ${key(3)}\n`, now - 30 * day);
+    writeCacheFile(dir, "config", key(4), `# CDN Configuration\n\narchives = ${key(5)}\n`, now - 30 * day);
+    writeCacheFile(dir, "config", key(10), `# Build Configuration\n\nencoding = ${key(11)} ${key(12)}\n`, now - day);
+    writeCacheFile(dir, "config", key(13), `# CDN Configuration\n\narchives = ${key(0x20)}\n`, now - day);
+    writeCacheFile(dir, "data", `${key(0x20)}.index`, Buffer.alloc(4000), now - 20 * day);
+    writeCacheFile(dir, "data", `${key(5)}.index`, Buffer.alloc(4000), now - 25 * day);
+    const oldData = writeCacheFile(dir, "data", key(0x30), Buffer.alloc(10000), now - 10 * day);
+    const newData = writeCacheFile(dir, "data", key(0x31), Buffer.alloc(10000), now - 2 * day);
+    fs.writeFileSync(path.join(dir, "versions"), "Region!STRING:0|BuildConfig!HEX:16\n");
+
+    const cache = new OnlineCache(dir, { maxBytes: 16000 });
+    const stats = cache.trim();
+
+    expect(stats.bytes).toBeLessThanOrEqual(16000);
+    expect(fs.existsSync(oldData)).toBe(false);
+    expect(fs.existsSync(newData)).toBe(true);
+    expect(fs.existsSync(path.join(dir, "data", "00", "00", `${key(0x20)}.index`))).toBe(true);
+    expect(fs.existsSync(path.join(dir, "data", "00", "00", `${key(5)}.index`))).toBe(false);
+    expect(fs.existsSync(path.join(dir, "config", "00", "00", key(10)))).toBe(true);
+    expect(fs.existsSync(path.join(dir, "versions"))).toBe(true);
+    expect(stats.evictedFiles).toBeGreaterThanOrEqual(2);
+    expect(stats.protectedFiles).toBeGreaterThanOrEqual(4);
+  });
+
+  it("should protect the current build's manifests by EKey", () => {
+    const day = 24 * 3600 * 1000;
+    const now = Date.now();
+
+    // ENCODING with one page that maps the root CKey 0x51 to EKey 0x61
+    const encoding = Buffer.alloc(22 + 32 + 1024);
+    encoding.write("EN", 0, "latin1");
+    encoding[2] = 1;
+    encoding[3] = 16;
+    encoding[4] = 16;
+    encoding.writeUInt16BE(1, 5);
+    encoding.writeUInt32BE(1, 9);
+    Buffer.from(key(0x50), "hex").copy(encoding, 22);
+    encoding[54] = 1;
+    Buffer.from(key(0x50), "hex").copy(encoding, 60);
+    Buffer.from(key(0x60), "hex").copy(encoding, 76);
+    encoding[92] = 1;
+    Buffer.from(key(0x51), "hex").copy(encoding, 98);
+    Buffer.from(key(0x61), "hex").copy(encoding, 114);
+
+    const blte = Buffer.concat([Buffer.from("BLTE"), Buffer.alloc(4), Buffer.from("N"), encoding]);
+    writeCacheFile(dir, "config", key(1),
+      `# Build Configuration\n\nroot = ${key(0x51)}\nencoding = ${key(0x52)} ${key(0x62)}\ninstall = ${key(0x53)} ${key(0x63)}\n`,
+      now - day);
+    const encodingFile = writeCacheFile(dir, "data", key(0x62), blte, now - 30 * day);
+    const rootFile = writeCacheFile(dir, "data", key(0x61), Buffer.alloc(4000), now - 30 * day);
+    const installFile = writeCacheFile(dir, "data", key(0x63), Buffer.alloc(4000), now - 30 * day);
+    const byCKey = writeCacheFile(dir, "data", key(0x53), Buffer.alloc(4000), now - 30 * day);
+    const stray = writeCacheFile(dir, "data", key(0x70), Buffer.alloc(4000), now - 20 * day);
+
+    const stats = new OnlineCache(dir, { maxBytes: 1 }).trim();
+
+    expect(fs.existsSync(encodingFile)).toBe(true);
+    expect(fs.existsSync(rootFile)).toBe(true);
+    expect(fs.existsSync(installFile)).toBe(true);
+    expect(fs.existsSync(byCKey)).toBe(false);
+    expect(fs.existsSync(stray)).toBe(false);
+    expect(stats.protectedFiles).toBe(4);
+  });
+
+  it("should count new files as downloaded and re-read files as reused across instances", () => {
+    const now = Date.now();
+    const cached = writeCacheFile(dir, "data", key(0x40), Buffer.alloc(100), now - 60000);
+
+    // The first scan of a folder only records what is there
+    expect(new OnlineCache(dir, { maxBytes: 1 << 20 }).refresh().downloadedFiles).toBe(0);
+
+    const cache = new OnlineCache(dir, { maxBytes: 1 << 20 });
+    writeCacheFile(dir, "data", key(0x41), Buffer.alloc(200), now);
+    fs.utimesSync(cached, new Date(now), new Date(now - 60000));
+
+    const stats = cache.refresh();
+    expect(stats.downloadedFiles).toBe(1);
+    expect(stats.downloadedBytes).toBe(200);
+    expect(stats.reusedFiles).toBe(1);
+    expect(stats.files).toBe(2);
+  });
+});
@@ -85,6 +85,7 @@ export interface MPQArchiveConstructor {
 export interface MPQFile {
   SFileReadFile(bytesToRead: number): Buffer;
   readFileAll(): Buffer;  // Helper function, not in StormLib.h
+  readFileInto(target: Buffer | ArrayBufferView | ArrayBuffer, offset?: number, length?: number): number;  // Helper function, not in StormLib.h
   SFileWriteFile(data: Buffer, compression: number): boolean;
   SFileFinishFile(): boolean;
   SFileGetFileSize(): number;
@@ -506,6 +506,18 @@ export class File {
     return this.file.readFileAll();
   }
 
+  /**
+   * Read data from the current position into a caller-supplied buffer
+   * The target can be reused across files to avoid an allocation per read.
+   * @param target - Buffer, TypedArray or ArrayBuffer to fill
+   * @param offset - Byte offset in the target to start writing at (default: 0)
+   * @param length - Maximum number of bytes to read (default: rest of the target)
+   * @returns Number of bytes read
+   */
+  readInto(target: Buffer | ArrayBufferView | ArrayBuffer, offset?: number, length?: number): number {
+    return this.file.readFileInto(target, offset || 0, length);
+  }
+
   /**
    * Get the file size
    * @returns File size in bytes
@@ -1,14 +1,35 @@
 #include "file.h"
+#include <algorithm>
 #include <vector>
 
 Napi::FunctionReference MpqFile::constructor;
 
+// Resolves a Buffer, TypedArray or ArrayBuffer to its backing memory
+static bool GetWritableBytes(const Napi::Value& value, uint8_t** data, size_t* length) {
+  if (value.IsTypedArray()) {
+    Napi::TypedArray array = value.As<Napi::TypedArray>();
+    *data = static_cast<uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+    *length = array.ByteLength();
+    return true;
+  }
+
+  if (value.IsArrayBuffer()) {
+    Napi::ArrayBuffer array = value.As<Napi::ArrayBuffer>();
+    *data = static_cast<uint8_t*>(array.Data());
+    *length = array.ByteLength();
+    return true;
+  }
+
+  return false;
+}
+
 Napi::Object MpqFile::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
 
   Napi::Function func = DefineClass(env, "File", {
     InstanceMethod("SFileReadFile", &MpqFile::Read),
     InstanceMethod("readFileAll", &MpqFile::ReadAll),
+    InstanceMethod("readFileInto", &MpqFile::ReadInto),
     InstanceMethod("SFileWriteFile", &MpqFile::Write),
     InstanceMethod("SFileFinishFile", &MpqFile::Finish),
     InstanceMethod("SFileGetFileSize", &MpqFile::GetSize),
@@ -62,16 +83,21 @@ Napi::Value MpqFile::Read(const Napi::CallbackInfo& info) {
     bytesToRead = info[0].As<Napi::Number>().Uint32Value();
   }
 
-  std::vector<uint8_t> buffer(bytesToRead);
+  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, bytesToRead);
   DWORD bytesRead = 0;
 
-  if (!SFileReadFile(hFile, buffer.data(), bytesToRead, &bytesRead, nullptr)) {
+  if (!SFileReadFile(hFile, buffer.Data(), bytesToRead, &bytesRead, nullptr)) {
     Napi::Error::New(env, "Failed to read file")
       .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Buffer<uint8_t>::Copy(env, buffer.data(), bytesRead);
+  // Only a short read (end of file) needs a smaller copy
+  if (bytesRead < bytesToRead) {
+    return Napi::Buffer<uint8_t>::Copy(env, buffer.Data(), bytesRead);
+  }
+
+  return buffer;
 }
 
 Napi::Value MpqFile::ReadAll(const Napi::CallbackInfo& info) {
@@ -89,16 +115,77 @@ Napi::Value MpqFile::ReadAll(const Napi::CallbackInfo& info) {
     return Napi::Buffer<uint8_t>::New(env, 0);
   }
 
-  std::vector<uint8_t> buffer(fileSize);
+  // Decompress straight into the memory backing the returned Buffer
+  Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, fileSize);
   DWORD bytesRead = 0;
 
-  if (!SFileReadFile(hFile, buffer.data(), fileSize, &bytesRead, nullptr)) {
+  if (!SFileReadFile(hFile, buffer.Data(), fileSize, &bytesRead, nullptr)) {
     Napi::Error::New(env, "Failed to read file")
       .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  return Napi::Buffer<uint8_t>::Copy(env, buffer.data(), bytesRead);
+  // Only a short read (position not at the start) needs a smaller copy
+  if (bytesRead < fileSize) {
+    return Napi::Buffer<uint8_t>::Copy(env, buffer.Data(), bytesRead);
+  }
+
+  return buffer;
+}
+
+Napi::Value MpqFile::ReadInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!isOpen || !hFile) {
+    Napi::Error::New(env, "File is not open")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+
+  if (info.Length() < 1 || !GetWritableBytes(info[0], &data, &capacity)) {
+    Napi::TypeError::New(env, "Expected Buffer, TypedArray or ArrayBuffer as first argument")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t offset = 0;
+  if (info.Length() > 1 && info[1].IsNumber()) {
+    offset = (size_t)info[1].As<Napi::Number>().Int64Value();
+  }
+
+  if (offset > capacity) {
+    Napi::RangeError::New(env, "Offset is outside of the target buffer")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t length = capacity - offset;
+  if (info.Length() > 2 && info[2].IsNumber()) {
+    size_t requested = (size_t)info[2].As<Napi::Number>().Int64Value();
+    if (requested > length) {
+      Napi::RangeError::New(env, "Length exceeds the target buffer")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    length = requested;
+  }
+
+  DWORD bytesToRead = (DWORD)std::min<size_t>(length, 0xFFFFFFFF);
+  DWORD bytesRead = 0;
+
+  // SFileReadFile reports ERROR_HANDLE_EOF for a short read, which is not a failure here
+  if (bytesToRead > 0 && !SFileReadFile(hFile, data + offset, bytesToRead, &bytesRead, nullptr)) {
+    if (SErrGetLastError() != ERROR_HANDLE_EOF) {
+      Napi::Error::New(env, "Failed to read file")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  return Napi::Number::New(env, bytesRead);
 }
 
 Napi::Value MpqFile::GetSize(const Napi::CallbackInfo& info) {
@@ -343,6 +343,31 @@ describe("File.readAll()", () => {
   });
 });
 
+describe("File.readInto()", () => {
+  const testContent = "Content read into a caller-supplied buffer!";
+
+  it("should read file data into a reusable buffer", () => {
+    const testDir = getTestDir("file-readinto");
+    ensureDir(testDir);
+    const sourceFile = path.join(testDir, "source.txt");
+    createTestFile(sourceFile, testContent);
+    const archivePath = path.join(testDir, "test.mpq");
+    const archive = new Archive();
+    archive.create(archivePath);
+    archive.addFile(sourceFile, "test.txt");
+    archive.close();
+
+    archive.open(archivePath);
+    const scratch = Buffer.alloc(1024);
+    const file = archive.openFile("test.txt");
+    const bytesRead = file.readInto(scratch, 8);
+    expect(bytesRead).toBe(testContent.length);
+    expect(scratch.subarray(8, 8 + bytesRead).toString()).toBe(testContent);
+    file.close();
+    archive.close();
+  });
+});
+
 describe("File.getSize()", () => {
   const testContent = "Content with known size";
 